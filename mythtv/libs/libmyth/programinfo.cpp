@@ -22,6 +22,7 @@ using namespace std;
 
 // MythTV headers
 #include "programinfoupdater.h"
+#include "seekindexfile.h"
 #include "mythcorecontext.h"
 #include "mythscheduler.h"
 #include "mythmiscutil.h"
@@ -3337,6 +3338,26 @@ void ProgramInfo::QueryPositionMap(
         posMap[query.value(0).toULongLong()] = query.value(1).toULongLong();
 }
 
+/// The seek index mirrors recordedseek, so remove it whenever the
+/// database copy is rewritten rather than let readers use stale offsets.
+/// When the recording is not local the backend holding it removes it.
+static void remove_seek_index(const ProgramInfo &pginfo)
+{
+    QString path = pginfo.GetPlaybackURL(false, true);
+    if (!path.startsWith("myth://"))
+    {
+        SeekIndexFile::Remove(path);
+        return;
+    }
+
+    QString url = SeekIndexFile::GetFilename(path);
+    if (RemoteFile::Exists(url) && !RemoteFile::DeleteFile(url))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Unable to remove seek index %1").arg(url));
+    }
+}
+
 void ProgramInfo::ClearPositionMap(MarkTypes type) const
 {
     if (positionMapDBReplacement)
@@ -3357,6 +3378,8 @@ void ProgramInfo::ClearPositionMap(MarkTypes type) const
     }
     else if (IsRecording())
     {
+        remove_seek_index(*this);
+
         query.prepare("DELETE FROM recordedseek"
                       " WHERE chanid = :CHANID"
                       " AND starttime = :STARTTIME"
@@ -3444,6 +3467,8 @@ void ProgramInfo::SavePositionMap(
     }
     else if (IsRecording())
     {
+        remove_seek_index(*this);
+
         query.prepare("DELETE FROM recordedseek"
                       " WHERE chanid = :CHANID"
                       " AND starttime = :STARTTIME"
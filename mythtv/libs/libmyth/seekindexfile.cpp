@@ -0,0 +1,244 @@
+// C headers
+#include <string.h>
+
+// C++ headers
+#include <algorithm> // for max
+using namespace std;
+
+// Qt headers
+#include <QFileInfo>
+#include <QFile>
+
+// MythTV headers
+#include "seekindexfile.h"
+#include "mythlogging.h"
+
+#define LOC QString("SeekIndex: ")
+
+static const char    kSeekIndexMagic[8] =
+    { 'M', 'Y', 'T', 'H', 'S', 'E', 'E', 'K' };
+static const uchar   kSeekIndexBlockMarker = 0xB7;
+static const int     kSeekIndexBlockHeader = 10;
+/// Recorders save keyframe positions before the data reaches the disk,
+/// so allow the index to point a little past the end of the file.
+static const int64_t kSeekIndexOffsetSlack = 64 * 1024 * 1024;
+
+static void put_le32(QByteArray &out, uint32_t v)
+{
+    out.append((char)(v & 0xff));
+    out.append((char)((v >> 8) & 0xff));
+    out.append((char)((v >> 16) & 0xff));
+    out.append((char)((v >> 24) & 0xff));
+}
+
+static uint32_t get_le32(const uchar *p)
+{
+    return ((uint32_t)p[0])       | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_varint(QByteArray &out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.append((char)((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.append((char)v);
+}
+
+static bool get_varint(const uchar *&p, const uchar *end, uint64_t &v)
+{
+    v = 0;
+    for (uint shift = 0; p < end && shift < 64; shift += 7)
+    {
+        uchar c = *p++;
+        v |= ((uint64_t)(c & 0x7f)) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+QString SeekIndexFile::GetFilename(const QString &recording)
+{
+    return recording + ".seek";
+}
+
+/** \brief Appends a position map delta to the recording's seek index.
+ *
+ *   If the write fails the index is removed, so readers use the
+ *   database rather than an incomplete index. The caller must not
+ *   append any further deltas after a failure, the index would then
+ *   start part way into the recording.
+ */
+bool SeekIndexFile::Append(const QString &recording,
+                           const frm_pos_map_t &delta, MarkTypes type)
+{
+    if (delta.empty())
+        return true;
+
+    QByteArray payload;
+    frm_pos_map_t::const_iterator it = delta.begin();
+    uint64_t last_frame  = it.key();
+    uint64_t last_offset = *it;
+    put_varint(payload, last_frame);
+    put_varint(payload, last_offset);
+    for (++it; it != delta.end(); ++it)
+    {
+        int64_t diff = (int64_t)(*it - last_offset);
+        put_varint(payload, it.key() - last_frame);
+        put_varint(payload, ((uint64_t)diff << 1) ^ (uint64_t)(diff >> 63));
+        last_frame  = it.key();
+        last_offset = *it;
+    }
+
+    QFile file(GetFilename(recording));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to open %1: %2")
+            .arg(file.fileName()).arg(file.errorString()));
+        return false;
+    }
+
+    QByteArray block;
+    block.reserve(sizeof(kSeekIndexMagic) + kSeekIndexBlockHeader +
+                  payload.size());
+    if (file.size() == 0)
+        block.append(kSeekIndexMagic, sizeof(kSeekIndexMagic));
+    block.append((char)kSeekIndexBlockMarker);
+    block.append((char)(int8_t)type);
+    put_le32(block, payload.size());
+    put_le32(block, delta.size());
+    block.append(payload);
+
+    if (file.write(block) != block.size() || !file.flush())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to write %1: %2")
+            .arg(file.fileName()).arg(file.errorString()));
+        file.close();
+        Remove(recording);
+        return false;
+    }
+
+    return true;
+}
+
+/** \brief Loads the position map of the given type from the recording's
+ *         seek index.
+ *
+ *  \return false if there is no usable index or it has no entries of
+ *          this type, the caller should then query the database.
+ */
+bool SeekIndexFile::Load(const QString &recording,
+                         frm_pos_map_t &posMap, MarkTypes type)
+{
+    QFile file(GetFilename(recording));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 size = file.size();
+    if (size < (qint64)sizeof(kSeekIndexMagic))
+        return false;
+
+    QByteArray copy;
+    const uchar *data = file.map(0, size);
+    if (!data)
+    {
+        copy = file.readAll();
+        data = reinterpret_cast<const uchar*>(copy.constData());
+        size = copy.size();
+    }
+
+    if (size < (qint64)sizeof(kSeekIndexMagic) ||
+        memcmp(data, kSeekIndexMagic, sizeof(kSeekIndexMagic)) != 0)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("%1 is not a seek index").arg(file.fileName()));
+        return false;
+    }
+
+    frm_pos_map_t map;
+    uint64_t max_offset = 0;
+    const uchar *p   = data + sizeof(kSeekIndexMagic);
+    const uchar *end = data + size;
+    while (end - p >= kSeekIndexBlockHeader)
+    {
+        if (p[0] != kSeekIndexBlockMarker)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("%1 is corrupt at byte %2, ignoring it")
+                .arg(file.fileName()).arg(p - data));
+            return false;
+        }
+
+        int      block_type = (int8_t)p[1];
+        uint32_t length     = get_le32(p + 2);
+        uint32_t count      = get_le32(p + 6);
+        p += kSeekIndexBlockHeader;
+        if ((uint64_t)(end - p) < length)
+            break; // truncated while appending
+
+        const uchar *block_end = p + length;
+        if (block_type != (int)type || !count)
+        {
+            p = block_end;
+            continue;
+        }
+
+        uint64_t frame, offset, diff;
+        bool ok = get_varint(p, block_end, frame) &&
+                  get_varint(p, block_end, offset);
+        map[frame] = offset;
+        max_offset = max(max_offset, offset);
+        for (uint32_t i = 1; ok && i < count; i++)
+        {
+            ok = get_varint(p, block_end, diff);
+            frame += diff;
+            ok = ok && get_varint(p, block_end, diff);
+            offset += (int64_t)(diff >> 1) ^ -(int64_t)(diff & 1);
+            map[frame] = offset;
+            max_offset = max(max_offset, offset);
+        }
+
+        if (!ok || p != block_end)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("%1 has a corrupt block, ignoring it")
+                .arg(file.fileName()));
+            return false;
+        }
+    }
+
+    if (map.empty())
+        return false;
+
+    // A transcode or cut can leave an index that no longer matches
+    QFileInfo info(recording);
+    if (info.exists() &&
+        (int64_t)max_offset > info.size() + kSeekIndexOffsetSlack)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("%1 points past the end of the recording, ignoring it")
+            .arg(file.fileName()));
+        return false;
+    }
+
+    posMap = map;
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Loaded %1 entries from %2")
+        .arg(posMap.size()).arg(file.fileName()));
+
+    return true;
+}
+
+/// \brief Removes the recording's seek index, if it has one.
+void SeekIndexFile::Remove(const QString &recording)
+{
+    QString fn = GetFilename(recording);
+    if (QFile::exists(fn) && !QFile::remove(fn))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to remove %1")
+            .arg(fn));
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef _SEEK_INDEX_FILE_H_
+#define _SEEK_INDEX_FILE_H_
+
+// Qt headers
+#include <QString>
+
+// MythTV headers
+#include "programtypes.h"
+#include "mythexp.h"
+
+/** \class SeekIndexFile
+ *  \brief A compact, append only copy of a recording's position map,
+ *         kept in a "<recording>.seek" file next to the recording.
+ *
+ *   Loading a long recording's position map from the recordedseek table
+ *   means a SELECT returning tens of thousands of rows, the seek index
+ *   lets local readers memory map the file instead. The database stays
+ *   the source of truth, readers fall back to it whenever the index is
+ *   missing, unreadable or does not match the recording.
+ *
+ *   The file starts with the 8 byte magic "MYTHSEEK" followed by blocks,
+ *   one per appended delta:
+ *
+ *   \code
+ *     uint8   marker (0xB7)
+ *     int8    mark type
+ *     uint32  payload length in bytes (little endian)
+ *     uint32  entry count (little endian)
+ *     payload: varint first frame, varint first offset, then for each
+ *              further entry the varint frame delta and the zigzag
+ *              varint offset delta
+ *   \endcode
+ *
+ *   A truncated trailing block, from a crash while appending, is ignored.
+ */
+class MPUBLIC SeekIndexFile
+{
+  public:
+    static QString GetFilename(const QString &recording);
+
+    static bool Append(const QString &recording,
+                       const frm_pos_map_t &delta, MarkTypes type);
+    static bool Load(const QString &recording,
+                     frm_pos_map_t &posMap, MarkTypes type);
+    static void Remove(const QString &recording);
+};
+
+#endif // _SEEK_INDEX_FILE_H_
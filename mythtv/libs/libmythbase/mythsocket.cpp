@@ -37,7 +37,8 @@ const uint MythSocket::kShortTimeout = kMythSocketShortTimeout;
 const uint MythSocket::kLongTimeout  = kMythSocketLongTimeout;
 
 QMutex MythSocket::s_readyread_thread_lock;
-MythSocketThread *MythSocket::s_readyread_thread = NULL;
+QList<MythSocketThread*> MythSocket::s_readyread_threads;
+uint MythSocket::s_readyread_next_thread = 0;
 
 QMap<QString, QHostAddress::SpecialAddress> MythSocket::s_loopback_cache;
 
@@ -48,7 +49,8 @@ MythSocket::MythSocket(int socket, MythSocketCBs *cb) :
     m_state(Idle),
     m_addr(),                   m_port(0),
     m_notifyread(false),        m_expectingreply(false),
-    m_isValidated(false),       m_isAnnounced(false)
+    m_isValidated(false),       m_isAnnounced(false),
+    m_readyread_thread(NULL)
 {
     LOG(VB_SOCKET, LOG_DEBUG, LOC + "new socket");
 
@@ -62,15 +64,20 @@ MythSocket::MythSocket(int socket, MythSocketCBs *cb) :
 #endif
     }
 
-    if (!s_readyread_thread)
     {
         QMutexLocker locker(&s_readyread_thread_lock);
-        if (!s_readyread_thread)
-            s_readyread_thread = new MythSocketThread();
+        if (s_readyread_threads.empty())
+        {
+            uint count = MythSocketThread::GetThreadCount();
+            for (uint i = 0; i < count; i++)
+                s_readyread_threads.push_back(new MythSocketThread(i));
+        }
+        m_readyread_thread = s_readyread_threads[
+            s_readyread_next_thread++ % s_readyread_threads.size()];
     }
 
     if (m_cb)
-        s_readyread_thread->AddToReadyRead(this);
+        m_readyread_thread->AddToReadyRead(this);
 }
 
 MythSocket::~MythSocket()
@@ -90,9 +97,9 @@ void MythSocket::setCallbacks(MythSocketCBs *cb)
     m_cb = cb;
 
     if (m_cb)
-        s_readyread_thread->AddToReadyRead(this);
+        m_readyread_thread->AddToReadyRead(this);
     else
-        s_readyread_thread->RemoveFromReadyRead(this);
+        m_readyread_thread->RemoveFromReadyRead(this);
 }
 
 int MythSocket::DecrRef(void)
@@ -102,7 +109,7 @@ int MythSocket::DecrRef(void)
     if (m_cb && ref == 1)
     {
         m_cb = NULL;
-        s_readyread_thread->RemoveFromReadyRead(this);
+        m_readyread_thread->RemoveFromReadyRead(this);
         // ready read thread will call DecrRef() & delete obj
     }
 
@@ -191,6 +198,9 @@ void MythSocket::setSocket(int socket, Type type)
     setBlocking(false);
     setState(Connected);
     setKeepalive(true);
+
+    if (m_cb && m_readyread_thread)
+        m_readyread_thread->UpdateReadyRead(this);
 }
 
 void MythSocket::close(void)
@@ -660,7 +670,7 @@ bool MythSocket::readStringList(QStringList &list, uint timeoutMS)
     list = str.split("[]:[]");
 
     m_notifyread = false;
-    s_readyread_thread->WakeReadyReadThread();
+    m_readyread_thread->WakeReadyReadThread();
     return true;
 }
 
@@ -714,7 +724,7 @@ bool MythSocket::SendReceiveStringList(
 void MythSocket::Lock(void) const
 {
     m_lock.lock();
-    s_readyread_thread->WakeReadyReadThread();
+    m_readyread_thread->WakeReadyReadThread();
 }
 
 bool MythSocket::TryLock(bool wake_readyread) const
@@ -722,7 +732,7 @@ bool MythSocket::TryLock(bool wake_readyread) const
     if (m_lock.tryLock())
     {
         if (wake_readyread)
-            s_readyread_thread->WakeReadyReadThread();
+            m_readyread_thread->WakeReadyReadThread();
         return true;
     }
     return false;
@@ -732,7 +742,7 @@ void MythSocket::Unlock(bool wake_readyread) const
 {
     m_lock.unlock();
     if (wake_readyread)
-        s_readyread_thread->WakeReadyReadThread();
+        m_readyread_thread->WakeReadyReadThread();
 }
 
 /**
@@ -825,6 +835,8 @@ bool MythSocket::connect(const QHostAddress &hadr, quint16 port)
     setReceiveBufferSize(kSocketBufferSize);
     setAddressReusable(true);
     setKeepalive(true);
+    if (m_cb)
+        m_readyread_thread->UpdateReadyRead(this); // new descriptor
     if (state() == Connecting)
     {
         setState(Connected);
@@ -832,7 +844,7 @@ bool MythSocket::connect(const QHostAddress &hadr, quint16 port)
         {
             LOG(VB_SOCKET, LOG_DEBUG, LOC + "calling m_cb->connected()");
             m_cb->connected(this);
-            s_readyread_thread->WakeReadyReadThread();
+            m_readyread_thread->WakeReadyReadThread();
         }
     }
     else
@@ -107,8 +107,11 @@ class MBASE_PUBLIC MythSocket :
     QStringList     m_announce;
 
     static const uint kSocketBufferSize;
+    MythSocketThread *m_readyread_thread;
+
     static QMutex s_readyread_thread_lock;
-    static MythSocketThread *s_readyread_thread;
+    static QList<MythSocketThread*> s_readyread_threads;
+    static uint s_readyread_next_thread;
     
     static QMap<QString, QHostAddress::SpecialAddress> s_loopback_cache;
 };
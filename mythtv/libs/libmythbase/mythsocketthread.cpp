@@ -1,5 +1,6 @@
 // ANSI C
 #include <cstdlib>
+#include <cstring>
 
 // C++
 #include <algorithm> // for min/max
@@ -14,11 +15,18 @@
 #include <sys/types.h>  // for fnctl
 #include <fcntl.h>      // for fnctl
 #include <errno.h>      // for checking errno
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 #ifndef O_NONBLOCK
 #define O_NONBLOCK 0 /* not actually supported in MINGW */
 #endif
 
+#if defined(__linux__) && !defined(EPOLLRDHUP)
+#define EPOLLRDHUP 0x2000 /* Linux 2.6.17, missing from older headers */
+#endif
+
 // Qt
 #include <QTime>
 
@@ -33,9 +41,11 @@
 #define LOC     QString("MythSocketThread: ")
 
 const uint MythSocketThread::kShortWait = 100;
+const int  MythSocketThread::kMaxEpollEvents = 64;
 
-MythSocketThread::MythSocketThread()
-    : MThread("Socket"), m_readyread_run(false)
+MythSocketThread::MythSocketThread(uint id)
+    : MThread(id ? QString("Socket%1").arg(id) : QString("Socket")),
+      m_readyread_run(false), m_epoll_fd(-1)
 {
     for (int i = 0; i < 2; i++)
     {
@@ -47,13 +57,25 @@ MythSocketThread::MythSocketThread()
 void ShutdownRRT(void)
 {
     QMutexLocker locker(&MythSocket::s_readyread_thread_lock);
-    if (MythSocket::s_readyread_thread)
+    QList<MythSocketThread*>::iterator it =
+        MythSocket::s_readyread_threads.begin();
+    for (; it != MythSocket::s_readyread_threads.end(); ++it)
     {
-        MythSocket::s_readyread_thread->ShutdownReadyReadThread();
-        MythSocket::s_readyread_thread->wait();
+        (*it)->ShutdownReadyReadThread();
+        (*it)->wait();
     }
 }
 
+/** \brief Returns the number of threads MythSockets are spread over,
+ *         from the MYTHTV_SOCKET_THREADS environment variable.
+ */
+uint MythSocketThread::GetThreadCount(void)
+{
+    const char *env = getenv("MYTHTV_SOCKET_THREADS");
+    uint count = env ? QString(env).toUInt() : 1;
+    return std::min(std::max(count, 1U), 16U);
+}
+
 void MythSocketThread::ShutdownReadyReadThread(void)
 {
     {
@@ -66,6 +88,12 @@ void MythSocketThread::ShutdownReadyReadThread(void)
     wait(); // waits for thread to exit
 
     CloseReadyReadPipe();
+
+    if (m_epoll_fd >= 0)
+    {
+        ::close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
 }
 
 void MythSocketThread::CloseReadyReadPipe(void) const
@@ -88,6 +116,32 @@ void MythSocketThread::StartReadyReadThread(void)
     {
         atexit(ShutdownRRT);
         setup_pipe(m_readyread_pipe, m_readyread_pipe_flags);
+#ifdef __linux__
+        // epoll needs the pipe to be woken up, otherwise use select()
+        if (m_readyread_pipe[0] >= 0 &&
+            (m_readyread_pipe_flags[0] & O_NONBLOCK))
+        {
+            m_epoll_fd = epoll_create(kMaxEpollEvents);
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events   = EPOLLIN;
+            ev.data.ptr = NULL;
+            if (m_epoll_fd < 0 ||
+                epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD,
+                          m_readyread_pipe[0], &ev) < 0)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    "Unable to use epoll, falling back to select" + ENO);
+                if (m_epoll_fd >= 0)
+                    ::close(m_epoll_fd);
+                m_epoll_fd = -1;
+            }
+            else
+            {
+                fcntl(m_epoll_fd, F_SETFD, FD_CLOEXEC);
+            }
+        }
+#endif
         m_readyread_run = true;
         start();
         m_readyread_started_wait.wait(&m_readyread_lock);
@@ -123,6 +177,19 @@ void MythSocketThread::RemoveFromReadyRead(MythSocket *sock)
     WakeReadyReadThread();
 }
 
+/// \brief Registers the socket again after its descriptor changed.
+void MythSocketThread::UpdateReadyRead(MythSocket *sock)
+{
+    if (m_epoll_fd < 0)
+        return;
+
+    {
+        QMutexLocker locker(&m_readyread_lock);
+        m_readyread_updatelist.push_back(sock);
+    }
+    WakeReadyReadThread();
+}
+
 void MythSocketThread::WakeReadyReadThread(void) const
 {
     if (!isRunning())
@@ -178,18 +245,74 @@ void MythSocketThread::ProcessAddRemoveQueues(void)
         MythSocket *sock = m_readyread_dellist.front();
         m_readyread_dellist.pop_front();
 
-        if (m_readyread_list.removeAll(sock))
+        if (m_readyread_list.remove(sock))
+        {
+            m_readyread_pending.remove(sock);
             m_readyread_downref_list.push_back(sock);
+        }
     }
 
     while (!m_readyread_addlist.empty())
     {
         MythSocket *sock = m_readyread_addlist.front();
         m_readyread_addlist.pop_front();
-        m_readyread_list.push_back(sock);
+
+        // drop the extra reference when a socket is added twice
+        if (m_readyread_list.contains(sock))
+        {
+            m_readyread_downref_list.push_back(sock);
+            continue;
+        }
+
+        m_readyread_list.insert(sock);
+        RegisterEpoll(sock);
+    }
+
+    while (!m_readyread_updatelist.empty())
+    {
+        MythSocket *sock = m_readyread_updatelist.front();
+        m_readyread_updatelist.pop_front();
+
+        if (m_readyread_list.contains(sock))
+            RegisterEpoll(sock);
     }
 }
 
+/** \brief Adds the socket's current descriptor to the epoll set.
+ *
+ *   Descriptors are never removed explicitly, closing a descriptor
+ *   removes it from the set. Removing it here could race with another
+ *   thread closing the socket and the number being reused by a new
+ *   socket. Events for sockets that are no longer in m_readyread_list
+ *   are ignored.
+ */
+void MythSocketThread::RegisterEpoll(MythSocket *sock)
+{
+#ifdef __linux__
+    int fd = sock->socket();
+    if (m_epoll_fd < 0 || fd < 0)
+        return;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = sock;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0 &&
+        (errno != EEXIST ||
+         epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &ev) < 0))
+    {
+        LOG(VB_GENERAL, LOG_ERR, SLOC(sock) +
+            "Failed to add socket to the epoll set" + ENO);
+        return;
+    }
+
+    // There is no edge for data that arrived before the socket was added
+    m_readyread_pending.insert(sock);
+#else
+    (void) sock;
+#endif
+}
+
 void MythSocketThread::run(void)
 {
     RunProlog();
@@ -197,6 +320,20 @@ void MythSocketThread::run(void)
 
     QMutexLocker locker(&m_readyread_lock);
     m_readyread_started_wait.wakeAll();
+
+    if (m_epoll_fd >= 0)
+        RunEpoll();
+    else
+        RunSelect();
+
+    LOG(VB_SOCKET, LOG_DEBUG, LOC + "readyread thread exit");
+    RunEpilog();
+}
+
+/// \brief Ready read loop polling every socket with select(),
+///        called with m_readyread_lock held.
+void MythSocketThread::RunSelect(void)
+{
     while (m_readyread_run)
     {
         LOG(VB_SOCKET, LOG_DEBUG, LOC + "ProcessAddRemoveQueues");
@@ -210,7 +347,7 @@ void MythSocketThread::run(void)
         fd_set rfds;
         FD_ZERO(&rfds);
 
-        QList<MythSocket*>::const_iterator it = m_readyread_list.begin();
+        QSet<MythSocket*>::const_iterator it = m_readyread_list.begin();
         for (; it != m_readyread_list.end(); ++it)
         {
             if (!(*it)->TryLock(false))
@@ -334,11 +471,10 @@ void MythSocketThread::run(void)
             LOG(VB_SOCKET, LOG_DEBUG, LOC + "Deleting stale sockets");
 
             QTime tm = QTime::currentTime();
-            for (it = m_readyread_downref_list.begin();
-                 it != m_readyread_downref_list.end(); ++it)
-            {
-                (*it)->DecrRef();
-            }
+            QList<MythSocket*>::const_iterator dit =
+                m_readyread_downref_list.begin();
+            for (; dit != m_readyread_downref_list.end(); ++dit)
+                (*dit)->DecrRef();
             m_readyread_downref_list.clear();
             downref_tm = tm.elapsed();
         }
@@ -383,7 +519,147 @@ void MythSocketThread::run(void)
         m_readyread_lock.lock();
         LOG(VB_SOCKET, LOG_DEBUG, LOC + "Reacquired ready read lock");
     }
+}
 
-    LOG(VB_SOCKET, LOG_DEBUG, LOC + "readyread thread exit");
-    RunEpilog();
+/** \brief Ready read loop using epoll, called with m_readyread_lock held.
+ *
+ *   Sockets are registered edge triggered, so each socket that became
+ *   readable is kept in m_readyread_pending until its callback was
+ *   called and it has no unread data left.
+ */
+void MythSocketThread::RunEpoll(void)
+{
+#ifdef __linux__
+    struct epoll_event events[kMaxEpollEvents];
+    bool again = false;
+
+    while (m_readyread_run)
+    {
+        ProcessAddRemoveQueues();
+
+        // Without the pipe we can not be woken up, so poll for events
+        int timeout = -1;
+        if (again)
+            timeout = 0;
+        else if (m_readyread_pipe[0] < 0)
+            timeout = kShortWait;
+
+        m_readyread_lock.unlock();
+        LOG(VB_SOCKET, LOG_DEBUG, LOC + "Waiting on epoll..");
+        int rval = epoll_wait(m_epoll_fd, events, kMaxEpollEvents, timeout);
+        int err = errno;
+        m_readyread_lock.lock();
+
+        if (rval < 0)
+        {
+            if (err != EINTR)
+            {
+                errno = err;
+                LOG(VB_SOCKET, LOG_ERR, LOC +
+                    "epoll_wait returned error" + ENO);
+                m_readyread_wait.wait(&m_readyread_lock, kShortWait);
+            }
+            continue;
+        }
+
+        for (int i = 0; i < rval; i++)
+        {
+            MythSocket *sock = (MythSocket*) events[i].data.ptr;
+            if (!sock)
+            {
+                // Clear out the wakeup pipe, the wakeup only makes us
+                // process the queues and the pending sockets again.
+                char dummy[128];
+                while (::read(m_readyread_pipe[0], dummy, 128) > 0)
+                    continue;
+            }
+            else if (m_readyread_list.contains(sock))
+            {
+                m_readyread_pending.insert(sock);
+            }
+        }
+
+        // ReadyToBeRead allows calls back into the socket so we need
+        // to release the lock for a little while.
+        // since only this loop updates m_readyread_list this is safe.
+        m_readyread_lock.unlock();
+
+        uint downref_tm = 0;
+        if (!m_readyread_downref_list.empty())
+        {
+            LOG(VB_SOCKET, LOG_DEBUG, LOC + "Deleting stale sockets");
+
+            QTime tm = QTime::currentTime();
+            QList<MythSocket*>::const_iterator dit =
+                m_readyread_downref_list.begin();
+            for (; dit != m_readyread_downref_list.end(); ++dit)
+                (*dit)->DecrRef();
+            m_readyread_downref_list.clear();
+            downref_tm = tm.elapsed();
+        }
+
+        LOG(VB_SOCKET, LOG_DEBUG, LOC + "Processing ready reads");
+
+        again = false;
+        QMap<uint,uint> timers;
+        QTime tm = QTime::currentTime();
+        QSet<MythSocket*>::iterator it = m_readyread_pending.begin();
+        while (it != m_readyread_pending.end() && m_readyread_run)
+        {
+            MythSocket *sock = *it;
+            if (!sock->TryLock(false))
+            {
+                ++it; // retried when the socket is unlocked
+                continue;
+            }
+
+            bool keep = false;
+            int socket = sock->socket();
+            if (socket >= 0 && sock->state() == MythSocket::Connected)
+            {
+                if (sock->m_notifyread)
+                {
+                    keep = true; // retried once the last data was read
+                }
+                else
+                {
+                    bool notify = sock->m_cb && sock->m_useReadyReadCallback;
+                    QTime rrtm = QTime::currentTime();
+                    ReadyToBeRead(sock);
+                    timers[socket] = rrtm.elapsed();
+
+                    // There is no new edge for data the callback left
+                    if (sock->state() == MythSocket::Connected &&
+                        sock->bytesAvailable() > 0)
+                    {
+                        keep = true;
+                        again |= notify && !sock->m_notifyread;
+                    }
+                }
+            }
+            sock->Unlock(false);
+
+            if (keep)
+                ++it;
+            else
+                it = m_readyread_pending.erase(it);
+        }
+
+        if (VERBOSE_LEVEL_CHECK(VB_SOCKET, LOG_DEBUG))
+        {
+            QString rep = QString("Total read time: %1ms, on sockets")
+                .arg(tm.elapsed());
+            QMap<uint,uint>::const_iterator it = timers.begin();
+            for (; it != timers.end(); ++it)
+                rep += QString(" {%1,%2ms}").arg(it.key()).arg(*it);
+            if (downref_tm)
+                rep += QString(" {downref, %1ms}").arg(downref_tm);
+            rep += QString(", %1 pending").arg(m_readyread_pending.size());
+
+            LOG(VB_SOCKET, LOG_DEBUG, LOC + rep);
+        }
+
+        m_readyread_lock.lock();
+    }
+#endif
 }
@@ -4,6 +4,7 @@
 #include <QWaitCondition>
 #include <QMutex>
 #include <QList>
+#include <QSet>
 
 #include "mythbaseexp.h"
 #include "mthread.h"
@@ -11,22 +12,40 @@
 MBASE_PUBLIC void ShutdownRRT(void);
 
 class MythSocket;
+
+/** \class MythSocketThread
+ *  \brief Calls the readyRead() callback of MythSockets with data waiting.
+ *
+ *   On Linux readiness comes from an edge triggered epoll set, so a wakeup
+ *   only looks at the sockets that have data. Elsewhere, or when epoll is
+ *   unavailable, every socket is polled with select().
+ *
+ *   Sockets are spread over GetThreadCount() threads. There is only one
+ *   unless the MYTHTV_SOCKET_THREADS environment variable asks for more,
+ *   callbacks for sockets on different threads may then run concurrently.
+ */
 class MythSocketThread : public MThread
 {
   public:
-    MythSocketThread();
+    MythSocketThread(uint id = 0);
 
     virtual void run(void);
 
+    static uint GetThreadCount(void);
+
     void StartReadyReadThread(void);
     void WakeReadyReadThread(void) const;
     void ShutdownReadyReadThread(void);
 
     void AddToReadyRead(MythSocket *sock);
     void RemoveFromReadyRead(MythSocket *sock);
+    void UpdateReadyRead(MythSocket *sock);
 
   private:
+    void RunSelect(void);
+    void RunEpoll(void);
     void ProcessAddRemoveQueues(void);
+    void RegisterEpoll(MythSocket *sock);
     void ReadyToBeRead(MythSocket *sock);
     void CloseReadyReadPipe(void) const;
 
@@ -38,12 +57,19 @@ class MythSocketThread : public MThread
     mutable int            m_readyread_pipe[2];
     mutable long           m_readyread_pipe_flags[2];
 
-    QList<MythSocket*> m_readyread_list;
+    int                    m_epoll_fd;
+
+    QSet<MythSocket*>  m_readyread_list;
     QList<MythSocket*> m_readyread_dellist;
     QList<MythSocket*> m_readyread_addlist;
+    QList<MythSocket*> m_readyread_updatelist;
     QList<MythSocket*> m_readyread_downref_list;
+    /// Sockets which became readable but were not handled yet, only
+    /// used by the epoll loop.
+    QSet<MythSocket*>  m_readyread_pending;
 
     static const uint kShortWait;
+    static const int  kMaxEpollEvents;
 };
 
 #endif // _MYTH_SOCKET_THREAD_H_
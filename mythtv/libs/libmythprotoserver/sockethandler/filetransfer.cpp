@@ -1,3 +1,4 @@
+#include <cerrno>
 
 using namespace std;
 
@@ -8,15 +9,21 @@ using namespace std;
 #include "ringbuffer.h"
 #include "programinfo.h"
 #include "mythsocket.h"
+#include "mythlogging.h"
 
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
                            MythSocketManager *parent,
                            bool usereadahead, int timeout_ms) :
     SocketHandler(remote, parent, ""),
     readthreadlive(true), readsLocked(false),
-    rbuffer(RingBuffer::Create(filename, false, usereadahead, timeout_ms)),
+    // sendfile() needs the file without our read-ahead, the kernel's
+    // page cache read-ahead takes its place
+    rbuffer(RingBuffer::Create(
+                filename, false,
+                usereadahead && !RingBuffer::CanSendFile(filename),
+                timeout_ms)),
     ateof(false), lock(QMutex::NonRecursive),
-    writemode(false)
+    writemode(false), usesendfile(true)
 {
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
@@ -28,7 +35,7 @@ FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
     readthreadlive(true), readsLocked(false),
     rbuffer(RingBuffer::Create(filename, write)),
     ateof(false), lock(QMutex::NonRecursive),
-    writemode(write)
+    writemode(write), usesendfile(!write)
 {
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
@@ -115,10 +122,36 @@ int FileTransfer::RequestBlock(int size)
 
     requestBuffer.resize(max((size_t)max(size,0) + 128, requestBuffer.size()));
     char *buf = &requestBuffer[0];
+    bool direct = usesendfile;
     while (tot < size && !rbuffer->GetStopReads() && readthreadlive)
     {
         int request = size - tot;
 
+        if (direct)
+        {
+            ret = rbuffer->SendFile(GetSocket()->socket(), request);
+            if (ret < 0 && errno == ENOSYS)
+            {
+                LOG(VB_FILE, LOG_INFO, "RequestBlock: sendfile() is not "
+                    "usable for this file, copying the data instead");
+                usesendfile = direct = false;
+                ret = 0;
+                continue;
+            }
+            if (ret < 0)
+            {
+                tot = -1;
+                break;
+            }
+
+            tot += ret;
+            // A short count means we reached the end of the file, which
+            // may still be recording; Read() waits for it to grow.
+            if (ret < request)
+                direct = false;
+            continue;
+        }
+
         ret = rbuffer->Read(buf, request);
         
         if (rbuffer->GetStopReads() || ret <= 0)
@@ -58,6 +58,7 @@ class FileTransfer : public SocketHandler
     QMutex lock;
 
     bool writemode;
+    bool usesendfile; ///< false once sendfile() failed for this file
 };
 
 #endif
@@ -23,6 +23,7 @@ using namespace std;
 #include "mythmiscutil.h"
 #include "mythcontext.h"
 #include "NuppelVideoRecorder.h"
+#include "positionmapwriter.h"
 #include "channelbase.h"
 #include "filtermanager.h"
 #include "recordingprofile.h"
@@ -2360,7 +2361,11 @@ void NuppelVideoRecorder::Reset(void)
         SetupAVCodecVideo();
 
     if (curRecording)
+    {
+        // don't let queued deltas from before the reset land after it
+        PositionMapWriter::Flush();
         curRecording->ClearPositionMap(MARK_KEYFRAME);
+    }
 }
 
 void NuppelVideoRecorder::doAudioThread(void)
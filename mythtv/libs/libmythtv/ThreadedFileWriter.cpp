@@ -11,11 +11,17 @@
 #include <fcntl.h>
 #include <string.h>
 
+// C++ headers
+#include <algorithm>
+using namespace std;
+
 // Qt headers
 #include <QString>
 
 // MythTV headers
 #include "ThreadedFileWriter.h"
+#include "mythcorecontext.h"
+#include "storagegroup.h"
 #include "mythlogging.h"
 
 #include "mythtimer.h"
@@ -42,6 +48,10 @@ void TFWSyncThread::run(void)
 
 const uint ThreadedFileWriter::kMaxBufferSize = 128 * 1024 * 1024;
 const uint ThreadedFileWriter::kMinWriteSize = 64 * 1024;
+const uint ThreadedFileWriter::kRingSize = 8 * 1024 * 1024;
+const uint ThreadedFileWriter::kDirectBlockSize = 1024 * 1024;
+const uint ThreadedFileWriter::kDirectAlign = 4096;
+const uint ThreadedFileWriter::kPreallocSize = 64 * 1024 * 1024;
 
 /** \class ThreadedFileWriter
  *  \brief This class supports the writing of recordings to disk.
@@ -64,8 +74,17 @@ ThreadedFileWriter::ThreadedFileWriter(const QString &fname,
     mode(pmode),                         fd(-1),
     // state
     flush(false),                        in_dtor(false),
-    ignore_writes(false),                tfw_min_write_size(kMinWriteSize),
-    totalBufferUse(0),
+    ignore_writes(false),                totalBufferUse(0),
+    // ring
+    ring(new char[kRingSize]),           ringHead(0),
+    ringTail(0),                         overflowing(false),
+    ringUnsignaled(0),                   tfw_min_write_size(kMinWriteSize),
+    highWater(0),                        overflowCount(0),
+    // direct I/O
+    directIO(false),                     dfd(-1),
+    dbuf(NULL),                          dbufUsed(0),
+    writePos(0),                         allocEnd(0),
+    preallocate(true),
     // threads
     writeThread(NULL),                   syncThread(NULL)
 {
@@ -86,6 +105,7 @@ bool ThreadedFileWriter::ReOpen(QString newFilename)
 
     if (fd >= 0)
     {
+        CloseDirectIO();
         close(fd);
         fd = -1;
     }
@@ -127,6 +147,8 @@ bool ThreadedFileWriter::Open(void)
 #ifdef USING_MINGW
         _setmode(fd, _O_BINARY);
 #endif
+        OpenDirectIO();
+
         if (!writeThread)
         {
             writeThread = new TFWWriteThread(this);
@@ -185,14 +207,239 @@ ThreadedFileWriter::~ThreadedFileWriter()
 
     if (fd >= 0)
     {
+        CloseDirectIO();
         close(fd);
         fd = -1;
     }
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Buffer high water mark %1 KB, ring overflowed %2 times")
+            .arg(highWater / 1024).arg(overflowCount));
+
+    delete[] ring;
+    free(dbuf);
+}
+
+/** \fn ThreadedFileWriter::UseDirectIO(void) const
+ *  \brief Returns true if the file is in one of the storage groups
+ *         listed in the DirectIOStorageGroups setting for this host.
+ */
+bool ThreadedFileWriter::UseDirectIO(void) const
+{
+    QString groups = gCoreContext->GetSetting("DirectIOStorageGroups", "");
+    if (groups.trimmed().isEmpty() || !filename.startsWith("/"))
+        return false;
+
+    QStringList list = groups.split(",", QString::SkipEmptyParts);
+    for (int i = 0; i < list.size(); i++)
+    {
+        StorageGroup sgroup(list[i].trimmed(), gCoreContext->GetHostName(),
+                            false);
+        QStringList dirs = sgroup.GetDirList();
+        for (int j = 0; j < dirs.size(); j++)
+        {
+            QString dir = dirs[j];
+            if (!dir.endsWith("/"))
+                dir += "/";
+            if (filename.startsWith(dir))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/** \fn ThreadedFileWriter::OpenDirectIO(void)
+ *  \brief Sets up direct I/O writeback if it is enabled for this file.
+ *
+ *   With direct I/O the data is gathered into page aligned blocks which
+ *   are written with O_DIRECT through a second descriptor, bypassing the
+ *   page cache, so that recordings do not evict the files being played
+ *   back. Space is preallocated ahead of the write position to keep the
+ *   file from fragmenting. The unaligned head and tail of each write are
+ *   written through the normal descriptor.
+ */
+void ThreadedFileWriter::OpenDirectIO(void)
+{
+    directIO = false;
+#ifdef O_DIRECT
+    if ((flags & O_APPEND) || !UseDirectIO())
+        return;
+
+    if (!dbuf && posix_memalign((void**)&dbuf, kDirectAlign, kDirectBlockSize))
+    {
+        dbuf = NULL;
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to allocate direct I/O buffer");
+        return;
+    }
+
+    QByteArray fname = filename.toLocal8Bit();
+    dfd = open(fname.constData(),
+               (flags & ~(O_CREAT | O_EXCL | O_TRUNC)) | O_DIRECT);
+    if (dfd < 0)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            "Direct I/O not available, using buffered writes" + ENO);
+        return;
+    }
+
+    writePos    = lseek(fd, 0, SEEK_CUR);
+    allocEnd    = writePos;
+    preallocate = true;
+    dbufUsed    = 0;
+    directIO    = true;
+
+    LOG(VB_FILE, LOG_INFO, LOC + "Using direct I/O writeback");
+#endif
+}
+
+/** \fn ThreadedFileWriter::CloseDirectIO(void)
+ *  \brief Releases the space preallocated past the end of the file and
+ *         closes the direct I/O descriptor.
+ *
+ *  \note This must be called after Flush(), with the file still open.
+ */
+void ThreadedFileWriter::CloseDirectIO(void)
+{
+    if (!directIO)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+    {
+        // Truncating to the current size frees blocks past the end of file
+        if (ftruncate(fd, st.st_size) < 0)
+            LOG(VB_FILE, LOG_WARNING, LOC + "ftruncate() failed" + ENO);
+    }
+
+    if (dfd >= 0)
+    {
+        close(dfd);
+        dfd = -1;
+    }
+    lseek(fd, writePos, SEEK_SET);
+    directIO = false;
+}
+
+/** \fn ThreadedFileWriter::StageDirectIO(void)
+ *  \brief Moves buffered data into the direct I/O block, oldest first.
+ *
+ *  \note buflock must be held when this is called.
+ */
+void ThreadedFileWriter::StageDirectIO(void)
+{
+    // The ring always holds the oldest data, so drain it first.
+    uint ring_used = RingUsed();
+    while (ring_used && (dbufUsed < kDirectBlockSize))
+    {
+        uint off = (uint) ringTail.fetchAndAddRelaxed(0) & (kRingSize - 1);
+        uint n = min(min(ring_used, kRingSize - off),
+                     kDirectBlockSize - dbufUsed);
+        memcpy(dbuf + dbufUsed, ring + off, n);
+        dbufUsed  += n;
+        ring_used -= n;
+        ringTail.fetchAndAddRelease(n);
+    }
+
+    while (!ring_used && !writeBuffers.empty() &&
+           (dbufUsed < kDirectBlockSize))
+    {
+        TFWBuffer *buf = writeBuffers.front();
+        uint n = min((uint) buf->data.size(), kDirectBlockSize - dbufUsed);
+        memcpy(dbuf + dbufUsed, &(buf->data[0]), n);
+        dbufUsed       += n;
+        totalBufferUse -= n;
+        if (n < buf->data.size())
+        {
+            buf->data.erase(buf->data.begin(), buf->data.begin() + n);
+        }
+        else
+        {
+            writeBuffers.pop_front();
+            buf->lastUsed = MythDate::current();
+            emptyBuffers.push_back(buf);
+        }
+    }
+}
+
+/** \fn ThreadedFileWriter::NextDirectIOChunk(uint&) const
+ *  \brief Picks how much of the direct I/O block to write next.
+ *
+ *   Aligned whole pages are written with O_DIRECT, anything needed to
+ *   bring the file offset back into alignment and any partial page at
+ *   the end of the data is written through the page cache.
+ *
+ *  \return true if the chunk should be written with O_DIRECT
+ */
+bool ThreadedFileWriter::NextDirectIOChunk(uint &sz) const
+{
+    uint misalign = writePos % kDirectAlign;
+    if (misalign)
+    {
+        sz = min(dbufUsed, kDirectAlign - misalign);
+        return false;
+    }
+    if ((dfd >= 0) && (dbufUsed >= kDirectAlign))
+    {
+        sz = dbufUsed - (dbufUsed % kDirectAlign);
+        return true;
+    }
+    sz = dbufUsed;
+    return false;
+}
+
+/** \fn ThreadedFileWriter::WriteDirectIO(bool, const char*, uint)
+ *  \brief Writes a chunk of the direct I/O block at writePos.
+ */
+int ThreadedFileWriter::WriteDirectIO(bool direct, const char *data, uint sz)
+{
+#ifdef O_DIRECT
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (direct && preallocate && (writePos + sz > allocEnd))
+    {
+        if (fallocate(fd, FALLOC_FL_KEEP_SIZE, writePos, kPreallocSize) == 0)
+        {
+            allocEnd = writePos + kPreallocSize;
+        }
+        else
+        {
+            LOG(VB_FILE, LOG_INFO, LOC +
+                "fallocate() failed, not preallocating" + ENO);
+            preallocate = false;
+        }
+    }
+#endif
+
+    int ret = pwrite((direct) ? dfd : fd, data, sz, writePos);
+    if ((ret < 0) && direct && (EINVAL == errno))
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            "Direct write failed, using buffered writes" + ENO);
+        close(dfd);
+        dfd = -1;
+        ret = pwrite(fd, data, sz, writePos);
+    }
+
+    if (ret > 0)
+        writePos += ret;
+
+    return ret;
+#else
+    (void) direct;
+    return write(fd, data, sz);
+#endif
 }
 
 /** \fn ThreadedFileWriter::Write(const void*, uint)
  *  \brief Writes data to the end of the write buffer
  *
+ *   The data is normally copied into a ring shared with DiskLoop()
+ *   without taking buflock. DiskLoop() is woken when the ring was
+ *   empty, since it may be waiting for up to a second, and then once
+ *   tfw_min_write_size bytes have been added. If the disk can not
+ *   keep up and the ring fills, WriteOverflow() queues the data in
+ *   writeBuffers until DiskLoop() catches up.
+ *
  *  \param data  pointer to data to write to disk
  *  \param count size of data in bytes
  */
@@ -201,12 +448,55 @@ uint ThreadedFileWriter::Write(const void *data, uint count)
     if (count == 0)
         return 0;
 
+    QMutexLocker wlocker(&writelock);
+
+    if (ignore_writes)
+        return count;
+
+    uint head = (uint) ringHead.fetchAndAddRelaxed(0);
+    uint used = head - (uint) ringTail.fetchAndAddAcquire(0);
+
+    if (overflowing || (used + count > kRingSize))
+        return WriteOverflow(data, count, used);
+
+    uint off   = head & (kRingSize - 1);
+    uint first = min(count, kRingSize - off);
+    memcpy(ring + off, data, first);
+    if (first < count)
+        memcpy(ring, (const char*)data + first, count - first);
+    ringHead.fetchAndAddRelease(count);
+
+    highWater = max(highWater, used + count);
+
+    // Read the tail again, DiskLoop() may have emptied the ring and gone
+    // to sleep since "used" was taken.
+    bool was_empty = ((uint) ringTail.fetchAndAddAcquire(0) == head);
+
+    ringUnsignaled += count;
+    if (was_empty || ringUnsignaled >= tfw_min_write_size)
+    {
+        ringUnsignaled = 0;
+        QMutexLocker locker(&buflock);
+        bufferHasData.wakeAll();
+    }
+
+    return count;
+}
+
+/** \fn ThreadedFileWriter::WriteOverflow(const void*, uint, uint)
+ *  \brief Queues data in writeBuffers when the ring is full.
+ *
+ *  \note writelock must be held when this is called.
+ */
+uint ThreadedFileWriter::WriteOverflow(
+    const void *data, uint count, uint ring_used)
+{
     QMutexLocker locker(&buflock);
 
     if (ignore_writes)
         return count;
 
-    if (totalBufferUse + count > kMaxBufferSize)
+    if (ring_used + totalBufferUse + count > kMaxBufferSize)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC +
                 "Maximum buffer size exceeded."
@@ -219,6 +509,15 @@ uint ThreadedFileWriter::Write(const void *data, uint count)
         return count;
     }
 
+    if (!overflowing)
+    {
+        overflowing = true;
+        overflowCount++;
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("Ring full with %1 KB, buffering further writes")
+                .arg(ring_used / 1024));
+    }
+
     TFWBuffer *buf = NULL;
 
     if (!writeBuffers.empty() &&
@@ -248,6 +547,8 @@ uint ThreadedFileWriter::Write(const void *data, uint count)
 
     writeBuffers.push_back(buf);
 
+    highWater = max(highWater, ring_used + totalBufferUse);
+
     bufferHasData.wakeAll();
 
     LOG(VB_FILE, LOG_DEBUG, LOC + QString("Write(*, %1) total %2 cnt %3")
@@ -271,17 +572,25 @@ long long ThreadedFileWriter::Seek(long long pos, int whence)
 {
     QMutexLocker locker(&buflock);
     flush = true;
-    while (!writeBuffers.empty())
+    while (!writeBuffers.empty() || RingUsed() || dbufUsed)
     {
         bufferHasData.wakeAll();
         if (!bufferEmpty.wait(locker.mutex(), 2000))
         {
             LOG(VB_GENERAL, LOG_WARNING, LOC +
                 QString("Taking a long time to flush.. buffer size %1")
-                    .arg(totalBufferUse));
+                    .arg(totalBufferUse + RingUsed()));
         }
     }
     flush = false;
+    if (directIO)
+    {
+        lseek(fd, writePos, SEEK_SET);
+        long long ret = lseek(fd, pos, whence);
+        if (ret >= 0)
+            writePos = ret;
+        return ret;
+    }
     return lseek(fd, pos, whence);
 }
 
@@ -292,14 +601,14 @@ void ThreadedFileWriter::Flush(void)
 {
     QMutexLocker locker(&buflock);
     flush = true;
-    while (!writeBuffers.empty())
+    while (!writeBuffers.empty() || RingUsed() || dbufUsed)
     {
         bufferHasData.wakeAll();
         if (!bufferEmpty.wait(locker.mutex(), 2000))
         {
             LOG(VB_GENERAL, LOG_WARNING, LOC +
                 QString("Taking a long time to flush.. buffer size %1")
-                    .arg(totalBufferUse));
+                    .arg(totalBufferUse + RingUsed()));
         }
     }
     flush = false;
@@ -346,9 +655,11 @@ void ThreadedFileWriter::Sync(void)
  */
 void ThreadedFileWriter::SetWriteBufferMinWriteSize(uint newMinSize)
 {
-    QMutexLocker locker(&buflock);
+    QMutexLocker wlocker(&writelock);
     if (newMinSize > 0)
         tfw_min_write_size = newMinSize;
+
+    QMutexLocker locker(&buflock);
     bufferHasData.wakeAll();
 }
 
@@ -389,8 +700,15 @@ void ThreadedFileWriter::DiskLoop(void)
 
     while (!in_dtor)
     {
+        // Once writeBuffers drains Write() can go back to the ring,
+        // anything still in the ring was written before it filled.
+        if (writeBuffers.empty())
+            overflowing = false;
+
         if (ignore_writes)
         {
+            ringTail.fetchAndAddRelease(RingUsed());
+            dbufUsed = 0;
             while (!writeBuffers.empty())
             {
                 delete writeBuffers.front();
@@ -406,7 +724,9 @@ void ThreadedFileWriter::DiskLoop(void)
             continue;
         }
 
-        if (writeBuffers.empty())
+        uint ring_used = RingUsed();
+
+        if (writeBuffers.empty() && !ring_used && !dbufUsed)
         {
             bufferEmpty.wakeAll();
             bufferHasData.wait(locker.mutex(), 1000);
@@ -415,13 +735,24 @@ void ThreadedFileWriter::DiskLoop(void)
         }
 
         int mwte = minWriteTimer.elapsed();
-        if (!flush && (mwte < 250) && (totalBufferUse < kMinWriteSize))
+        uint pending = totalBufferUse + ring_used + dbufUsed;
+        if (!flush && (mwte < 250) && (pending < kMinWriteSize))
         {
             bufferHasData.wait(locker.mutex(), 250 - mwte);
             TrimEmptyBuffers();
             continue;
         }
 
+        // Direct I/O wants whole blocks, but don't hold back data
+        // from the readers of a file that is still growing for long.
+        if (directIO && !flush && (mwte < 1000) &&
+            (pending < kDirectBlockSize))
+        {
+            bufferHasData.wait(locker.mutex(), 1000 - mwte);
+            TrimEmptyBuffers();
+            continue;
+        }
+
         if (fd == -1)
         {
             bufferHasData.wait(locker.mutex(), 200);
@@ -429,16 +760,35 @@ void ThreadedFileWriter::DiskLoop(void)
             continue;
         }
 
-        TFWBuffer *buf = writeBuffers.front();
-        writeBuffers.pop_front();
-        totalBufferUse -= buf->data.size();
+        // The ring always holds the oldest data, so drain it first.
+        TFWBuffer *buf = NULL;
+        const void *data;
+        uint sz;
+        bool direct = false;
+        if (directIO)
+        {
+            StageDirectIO();
+            direct = NextDirectIOChunk(sz);
+            data = dbuf;
+        }
+        else if (ring_used)
+        {
+            uint off = (uint) ringTail.fetchAndAddRelaxed(0) & (kRingSize - 1);
+            data = ring + off;
+            sz = min(ring_used, kRingSize - off);
+        }
+        else
+        {
+            buf = writeBuffers.front();
+            writeBuffers.pop_front();
+            totalBufferUse -= buf->data.size();
+            data = &(buf->data[0]);
+            sz = buf->data.size();
+        }
         minWriteTimer.start();
 
         //////////////////////////////////////////
 
-        const void *data = &(buf->data[0]);
-        uint sz = buf->data.size();
-
         bool write_ok = true;
         uint tot = 0;
         uint errcnt = 0;
@@ -454,7 +804,11 @@ void ThreadedFileWriter::DiskLoop(void)
         {
             locker.unlock();
 
-            int ret = write(fd, (char *)data + tot, sz - tot);
+            int ret;
+            if (directIO)
+                ret = WriteDirectIO(direct, (const char *)data + tot, sz - tot);
+            else
+                ret = write(fd, (char *)data + tot, sz - tot);
 
             if (ret < 0)
             {
@@ -489,8 +843,20 @@ void ThreadedFileWriter::DiskLoop(void)
 
         //////////////////////////////////////////
 
-        buf->lastUsed = MythDate::current();
-        emptyBuffers.push_back(buf);
+        if (directIO)
+        {
+            dbufUsed -= sz;
+            memmove(dbuf, dbuf + sz, dbufUsed);
+        }
+        else if (buf)
+        {
+            buf->lastUsed = MythDate::current();
+            emptyBuffers.push_back(buf);
+        }
+        else
+        {
+            ringTail.fetchAndAddRelease(sz);
+        }
 
         if (writeTimer.elapsed() > 1000)
         {
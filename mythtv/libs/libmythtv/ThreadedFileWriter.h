@@ -7,6 +7,7 @@ using namespace std;
 
 #include <QWaitCondition>
 #include <QDateTime>
+#include <QAtomicInt>
 #include <QString>
 #include <QMutex>
 
@@ -60,6 +61,18 @@ class ThreadedFileWriter
     void DiskLoop(void);
     void SyncLoop(void);
     void TrimEmptyBuffers(void);
+    uint WriteOverflow(const void *data, uint count, uint ring_used);
+    bool UseDirectIO(void) const;
+    void OpenDirectIO(void);
+    void CloseDirectIO(void);
+    void StageDirectIO(void);
+    bool NextDirectIOChunk(uint &sz) const;
+    int  WriteDirectIO(bool direct, const char *data, uint sz);
+    uint RingUsed(void) const
+    {
+        return (uint) ringHead.fetchAndAddAcquire(0) -
+               (uint) ringTail.fetchAndAddAcquire(0);
+    }
 
   private:
     // file info
@@ -71,10 +84,22 @@ class ThreadedFileWriter
     // state
     bool            flush;              // protected by buflock
     bool            in_dtor;            // protected by buflock
-    bool            ignore_writes;      // protected by buflock
-    uint            tfw_min_write_size; // protected by buflock
+    volatile bool   ignore_writes;      // set with buflock held
     uint            totalBufferUse;     // protected by buflock
 
+    // single producer, single consumer ring used by Write()
+    QMutex          writelock;          // serializes callers of Write()
+    char           *ring;
+    mutable QAtomicInt ringHead;        // bytes added by Write()
+    mutable QAtomicInt ringTail;        // bytes removed by DiskLoop()
+    /// While set, Write() appends to writeBuffers rather than the ring,
+    /// so the ring only ever holds data older than that in writeBuffers.
+    volatile bool   overflowing;        // set with buflock held
+    uint            ringUnsignaled;     // protected by writelock
+    uint            tfw_min_write_size; // protected by writelock
+    uint            highWater;          // protected by writelock
+    uint            overflowCount;      // protected by writelock
+
     // buffers
     class TFWBuffer
     {
@@ -86,6 +111,15 @@ class ThreadedFileWriter
     QList<TFWBuffer*> writeBuffers;     // protected by buflock
     QList<TFWBuffer*> emptyBuffers;     // protected by buflock
 
+    // direct I/O writeback, see OpenDirectIO()
+    bool            directIO;
+    int             dfd;                // O_DIRECT descriptor, or -1
+    char           *dbuf;               // aligned staging block
+    uint            dbufUsed;           // protected by buflock
+    long long       writePos;           // file offset of the next write
+    long long       allocEnd;           // end of the preallocated space
+    bool            preallocate;
+
     // threads
     TFWWriteThread *writeThread;
     TFWSyncThread  *syncThread;
@@ -97,6 +131,14 @@ class ThreadedFileWriter
 
     // constants
     static const uint kMaxBufferSize;
+    /// Size of the ring used by Write(), must be a power of two.
+    static const uint kRingSize;
+    /// Size of the blocks written with direct I/O.
+    static const uint kDirectBlockSize;
+    /// Alignment of direct I/O buffers, lengths and file offsets.
+    static const uint kDirectAlign;
+    /// Space preallocated ahead of the write position with direct I/O.
+    static const uint kPreallocSize;
     /// Minimum to write to disk in a single write, when not flushing buffer.
     static const uint kMinWriteSize;
 };
@@ -1041,18 +1041,22 @@ static void update_info(ChannelInsertInfo &info,
     // HACK end -- special exception for this network
 
     // Figure out best service name and callsign...
+    // This runs on the scanner thread, which has no ISDB flavour of its
+    // own, so take it from the network like DVBStreamData does.
+    ISDBTYPE isdbtype =
+        ISDBTextDecoder::TypeForNetwork(sdt->OriginalNetworkID());
     ServiceDescriptor *desc = sdt->GetServiceDescriptor(i);
     QString callsign = QString::null;
     QString service_name = QString::null;
     if (desc)
     {
-        callsign = desc->ServiceShortName();
+        callsign = desc->ServiceShortName(isdbtype);
         if (callsign.trimmed().isEmpty())
             callsign = QString("%1-%2-%3")
                 .arg(ChannelUtil::GetUnknownCallsign()).arg(sdt->TSID())
                 .arg(sdt->ServiceID(i));
 
-        service_name = desc->ServiceName();
+        service_name = desc->ServiceName(isdbtype);
         if (service_name.trimmed().isEmpty())
             service_name = QString::null;
     }
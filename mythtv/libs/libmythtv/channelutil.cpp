@@ -10,6 +10,7 @@ using namespace std;
 #include <QImage>
 #include <QFile>
 #include <QReadWriteLock>
+#include <QAtomicInt>
 #include <QHash>
 
 #include "channelutil.h"
@@ -21,6 +22,25 @@ using namespace std;
 
 const QString ChannelUtil::kATSCSeparators = "(_|-|#|\\.)";
 
+static QAtomicInt channel_table_generation;
+
+/// Called after this process has changed the channel or multiplex tables.
+static void channel_table_changed(void)
+{
+    channel_table_generation.fetchAndAddRelaxed(1);
+}
+
+/** \brief Returns a counter that changes whenever this process modifies
+ *         the channel or dtv_multiplex tables through ChannelUtil.
+ *
+ *  Caches of channel data can compare it against the value they were
+ *  built with to notice that they have gone stale.
+ */
+uint ChannelUtil::GetChannelTableGeneration(void)
+{
+    return channel_table_generation.fetchAndAddRelaxed(0);
+}
+
 static uint get_dtv_multiplex(uint     db_source_id,  QString sistandard,
                               uint64_t frequency,
                               // DVB specific
@@ -261,6 +281,8 @@ static uint insert_dtv_multiplex(
         return 0;
     }
 
+    channel_table_changed();
+
     if (mplex)
         return mplex;
 
@@ -1207,7 +1229,11 @@ bool ChannelUtil::SetChannelValue(const QString &field_name,
     query.bindValue(":CHANNUM",  channum);
     query.bindValue(":SOURCEID", sourceid);
 
-    return query.exec();
+    if (!query.exec())
+        return false;
+
+    channel_table_changed();
+    return true;
 }
 
 bool ChannelUtil::SetChannelValue(const QString &field_name,
@@ -1223,7 +1249,11 @@ bool ChannelUtil::SetChannelValue(const QString &field_name,
     query.bindValue(":VALUE",  value);
     query.bindValue(":CHANID", chanid);
 
-    return query.exec();
+    if (!query.exec())
+        return false;
+
+    channel_table_changed();
+    return true;
 }
 
 /** Returns the DVB default authority for the chanid given. */
@@ -1609,6 +1639,8 @@ bool ChannelUtil::CreateChannel(uint db_mplexid,
         MythDB::DBError("Adding Service", query);
         return false;
     }
+
+    channel_table_changed();
     return true;
 }
 
@@ -1691,6 +1723,8 @@ bool ChannelUtil::UpdateChannel(uint db_mplexid,
         MythDB::DBError("Updating Service", query);
         return false;
     }
+
+    channel_table_changed();
     return true;
 }
 
@@ -1740,6 +1774,8 @@ bool ChannelUtil::DeleteChannel(uint channel_id)
         return false;
     }
 
+    channel_table_changed();
+
     return true;
 }
 
@@ -142,6 +142,8 @@ class MTV_PUBLIC ChannelUtil
 
     static bool    SetServiceVersion(int mplexid, int version);
 
+    static uint    GetChannelTableGeneration(void);
+
     static int     GetChanID(int db_mplexid,    int service_transport_id,
                              int major_channel, int minor_channel,
                              int program_number);
@@ -12,6 +12,7 @@ using namespace std;
 #include "mythlogging.h"
 #include "decoderbase.h"
 #include "programinfo.h"
+#include "seekindexfile.h"
 #include "livetvchain.h"
 #include "iso639.h"
 #include "DVD/dvdringbuffer.h"
@@ -113,6 +114,25 @@ void DecoderBase::SetWatchingRecording(bool mode)
         SyncPositionMap();
 }
 
+/** \brief Loads the position map from the recording's seek index if it
+ *         is a local file with one, otherwise from the database.
+ */
+void DecoderBase::QueryPositionMap(frm_pos_map_t &posMap,
+                                   MarkTypes type) const
+{
+    if (m_playbackinfo->IsRecording() && ringBuffer)
+    {
+        QString filename = ringBuffer->GetFilename();
+        if (!filename.startsWith("myth://") &&
+            SeekIndexFile::Load(filename, posMap, type))
+        {
+            return;
+        }
+    }
+
+    m_playbackinfo->QueryPositionMap(posMap, type);
+}
+
 bool DecoderBase::PosMapFromDb(void)
 {
     if (!m_playbackinfo)
@@ -151,7 +171,7 @@ bool DecoderBase::PosMapFromDb(void)
     else if ((positionMapType == MARK_UNSET) ||
         (keyframedist == -1))
     {
-        m_playbackinfo->QueryPositionMap(posMap, MARK_GOP_BYFRAME);
+        QueryPositionMap(posMap, MARK_GOP_BYFRAME);
         if (!posMap.empty())
         {
             positionMapType = MARK_GOP_BYFRAME;
@@ -160,7 +180,7 @@ bool DecoderBase::PosMapFromDb(void)
         }
         else
         {
-            m_playbackinfo->QueryPositionMap(posMap, MARK_GOP_START);
+            QueryPositionMap(posMap, MARK_GOP_START);
             if (!posMap.empty())
             {
                 positionMapType = MARK_GOP_START;
@@ -173,7 +193,7 @@ bool DecoderBase::PosMapFromDb(void)
             }
             else
             {
-                m_playbackinfo->QueryPositionMap(posMap, MARK_KEYFRAME);
+                QueryPositionMap(posMap, MARK_KEYFRAME);
                 if (!posMap.empty())
                 {
                     // keyframedist should be set in the fileheader so no
@@ -185,7 +205,7 @@ bool DecoderBase::PosMapFromDb(void)
     }
     else
     {
-        m_playbackinfo->QueryPositionMap(posMap, positionMapType);
+        QueryPositionMap(posMap, positionMapType);
     }
 
     if (posMap.empty())
@@ -469,6 +489,25 @@ bool DecoderBase::FindPosition(long long desired_value, bool search_adjusted,
     return false;
 }
 
+/** \brief Returns the number of the last keyframe at or before frame,
+ *         or -1 if the position map does not cover frame.
+ */
+long long DecoderBase::GetKeyframeBefore(long long frame)
+{
+    if (!GetPositionMapSize())
+        return -1;
+
+    int lower, upper;
+    FindPosition(frame, hasKeyFrameAdjustTable, lower, upper);
+
+    QMutexLocker locker(&m_positionMapLock);
+    if (lower < 0 || lower >= (int)m_positionMap.size())
+        return -1;
+
+    long long key = GetKey(m_positionMap[lower]);
+    return (key <= frame) ? key : -1;
+}
+
 uint64_t DecoderBase::SavePositionMapDelta(uint64_t first, uint64_t last)
 {
     MythTimer ttm, ctm, stm;
@@ -184,6 +184,7 @@ class DecoderBase
     bool IsErrored() const { return errored; }
 
     bool HasPositionMap(void) const { return GetPositionMapSize(); }
+    long long GetKeyframeBefore(long long frame);
 
     void SetWaitForChange(void);
     bool GetWaitForChange(void) const;
@@ -219,6 +220,8 @@ class DecoderBase
 
     void SaveTotalDuration(void);
     void ResetTotalDuration(void) { totalDuration = 0; }
+    int64_t GetTotalDuration(void) const { return totalDuration; }
+    void AddTotalDuration(int64_t duration) { totalDuration += duration; }
     void SaveTotalFrames(void);
     bool GetVideoInverted(void) const { return video_inverted; }
 
@@ -232,6 +235,7 @@ class DecoderBase
     virtual bool DoRewindSeek(long long desiredFrame);
     virtual void DoFastForwardSeek(long long desiredFrame, bool &needflush);
 
+    void QueryPositionMap(frm_pos_map_t &posMap, MarkTypes type) const;
     long long ConditionallyUpdatePosMap(long long desiredFrame);
     long long GetLastFrameInPosMap(void) const;
     unsigned long GetPositionMapSize(void) const;
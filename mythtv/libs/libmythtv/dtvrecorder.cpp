@@ -22,21 +22,20 @@
 #include "mpegstreamdata.h"
 #include "dvbstreamdata.h"
 #include "dtvrecorder.h"
+#include "positionmapwriter.h"
 #include "programinfo.h"
 #include "mythlogging.h"
 #include "mpegtables.h"
 #include "ringbuffer.h"
+#include "startcode.h"
 #include "tv_rec.h"
 
-extern "C" {
-#include "libavcodec/mpegvideo.h"
-}
-
 #define LOC ((tvrec) ? \
     QString("DTVRec(%1): ").arg(tvrec->GetCaptureCardNum()) : \
     QString("DTVRec(0x%1): ").arg(intptr_t(this),0,16))
 
 const uint DTVRecorder::kMaxKeyFrameDistance = 80;
+const uint DTVRecorder::kWriteBufferSize = 64 * 1024;
 
 /** \class DTVRecorder
  *  \brief This is a specialization of RecorderBase used to
@@ -72,6 +71,9 @@ DTVRecorder::DTVRecorder(TVRec *rec) :
     // TS packet buffer
     // keyframe TS buffer
     _buffer_packets(false),
+    // output buffer
+    _write_buffer_packets(0),
+    _write_buffer_writes(0),
     // general recorder stuff
     _pid_lock(QMutex::Recursive),
     _input_pat(NULL),
@@ -85,6 +87,7 @@ DTVRecorder::DTVRecorder(TVRec *rec) :
 {
     SetPositionMapType(MARK_GOP_BYFRAME);
     _payload_buffer.reserve(TSPacket::kSize * (50 + 1));
+    _write_buffer.reserve(kWriteBufferSize + TSPacket::kSize * (50 + 1));
 
     ResetForNewFile();
 
@@ -149,6 +152,8 @@ void DTVRecorder::SetOptionsFromProfile(RecordingProfile *profile,
  */
 void DTVRecorder::FinishRecording(void)
 {
+    FlushWriteBuffer();
+
     if (ringBuffer)
         ringBuffer->WriterFlush();
 
@@ -222,7 +227,11 @@ void DTVRecorder::Reset(void)
     _start_code = 0xffffffff;
 
     if (curRecording)
+    {
+        // don't let queued deltas from before the reset land after it
+        PositionMapWriter::Flush();
         curRecording->ClearPositionMap(MARK_GOP_BYFRAME);
+    }
 }
 
 void DTVRecorder::SetStreamData(MPEGStreamData *data)
@@ -266,35 +275,8 @@ void DTVRecorder::BufferedWrite(const TSPacket &tspacket, bool insert)
             _first_keyframe < 0)
             return;
 
-        if (curRecording && timeOfFirstDataIsSet.testAndSetRelaxed(0,1))
-        {
-            QMutexLocker locker(&statisticsLock);
-            timeOfFirstData = MythDate::current();
-            timeOfLatestData = MythDate::current();
-            timeOfLatestDataTimer.start();
-        }
-
-        int val = timeOfLatestDataCount.fetchAndAddRelaxed(1);
-        int thresh = timeOfLatestDataPacketInterval.fetchAndAddRelaxed(0);
-        if (val > thresh)
-        {
-            QMutexLocker locker(&statisticsLock);
-            uint elapsed = timeOfLatestDataTimer.restart();
-            int interval = thresh;
-            if (elapsed > kTimeOfLatestDataIntervalTarget + 250)
-                interval = timeOfLatestDataPacketInterval
-                           .fetchAndStoreRelaxed(thresh * 4 / 5);
-            else if (elapsed + 250 < kTimeOfLatestDataIntervalTarget)
-                interval = timeOfLatestDataPacketInterval
-                           .fetchAndStoreRelaxed(thresh * 9 / 8);
-
-            timeOfLatestDataCount.fetchAndStoreRelaxed(1);
-            timeOfLatestData = MythDate::current();
-
-            LOG(VB_RECORD, LOG_DEBUG, LOC +
-                QString("Updating timeOfLatestData elapsed(%1) interval(%2)")
-                .arg(elapsed).arg(interval));
-        }
+        // counted towards timeOfLatestData in FlushWriteBuffer()
+        _write_buffer_packets++;
 
         // Do we have to buffer the packet for exact keyframe detection?
         if (_buffer_packets)
@@ -309,14 +291,104 @@ void DTVRecorder::BufferedWrite(const TSPacket &tspacket, bool insert)
         // we have to write them first...
         if (!_payload_buffer.empty())
         {
-            if (ringBuffer)
-                ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
+            WriteToRingBuffer(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
         }
     }
 
+    WriteToRingBuffer(tspacket.data(), TSPacket::kSize);
+}
+
+/** \fn DTVRecorder::WriteToRingBuffer(const void*, uint)
+ *  \brief Appends data to the output buffer.
+ *
+ *   Packets are collected here and handed to the RingBuffer in one
+ *   call once kWriteBufferSize bytes are buffered, at each keyframe,
+ *   before a RingBuffer switch, and when data has been buffered for
+ *   more than a quarter second. Use GetWritePosition() rather than
+ *   RingBuffer::GetWritePosition() for file offsets of written data.
+ */
+void DTVRecorder::WriteToRingBuffer(const void *data, uint len)
+{
+    if (!ringBuffer)
+        return;
+
+    if (_write_buffer.empty())
+        _write_buffer_timer.start();
+
+    const unsigned char *cdata = (const unsigned char*) data;
+    _write_buffer.insert(_write_buffer.end(), cdata, cdata + len);
+
+    // Only look at the clock every so often, it is not free either
+    if ((_write_buffer.size() >= kWriteBufferSize) ||
+        (((++_write_buffer_writes & 0x3f) == 0) &&
+         (_write_buffer_timer.elapsed() > 250)))
+    {
+        FlushWriteBuffer();
+    }
+}
+
+/** \fn DTVRecorder::FlushWriteBuffer(void)
+ *  \brief Writes the output buffer to the RingBuffer.
+ */
+void DTVRecorder::FlushWriteBuffer(void)
+{
+    if (_write_buffer_packets)
+    {
+        UpdateLatestDataTime(_write_buffer_packets);
+        _write_buffer_packets = 0;
+    }
+
+    if (_write_buffer.empty())
+        return;
+
     if (ringBuffer)
-        ringBuffer->Write(tspacket.data(), TSPacket::kSize);
+        ringBuffer->Write(&_write_buffer[0], _write_buffer.size());
+    _write_buffer.clear();
+}
+
+/// File offset the next byte passed to WriteToRingBuffer() will have
+int64_t DTVRecorder::GetWritePosition(void) const
+{
+    return ringBuffer->GetWritePosition() + _write_buffer.size();
+}
+
+/** \fn DTVRecorder::UpdateLatestDataTime(uint)
+ *  \brief Updates timeOfFirstData and timeOfLatestData.
+ *
+ *  \param packets number of packets received since the last call
+ */
+void DTVRecorder::UpdateLatestDataTime(uint packets)
+{
+    if (curRecording && timeOfFirstDataIsSet.testAndSetRelaxed(0,1))
+    {
+        QMutexLocker locker(&statisticsLock);
+        timeOfFirstData = MythDate::current();
+        timeOfLatestData = MythDate::current();
+        timeOfLatestDataTimer.start();
+    }
+
+    int val = timeOfLatestDataCount.fetchAndAddRelaxed(packets);
+    int thresh = timeOfLatestDataPacketInterval.fetchAndAddRelaxed(0);
+    if (val > thresh)
+    {
+        QMutexLocker locker(&statisticsLock);
+        uint elapsed = timeOfLatestDataTimer.restart();
+        int interval = thresh;
+        if (elapsed > kTimeOfLatestDataIntervalTarget + 250)
+            interval = timeOfLatestDataPacketInterval
+                       .fetchAndStoreRelaxed(thresh * 4 / 5);
+        else if (elapsed + 250 < kTimeOfLatestDataIntervalTarget)
+            interval = timeOfLatestDataPacketInterval
+                       .fetchAndStoreRelaxed(thresh * 9 / 8);
+
+        timeOfLatestDataCount.fetchAndStoreRelaxed(1);
+        timeOfLatestData = MythDate::current();
+
+        LOG(VB_RECORD, LOG_DEBUG, LOC +
+            QString("Updating timeOfLatestData elapsed(%1) interval(%2)")
+            .arg(elapsed).arg(interval));
+    }
 }
 
 enum { kExtractPTS, kExtractDTS };
@@ -427,7 +499,7 @@ bool DTVRecorder::FindMPEG2Keyframes(const TSPacket* tspacket)
 
     while (bufptr < bufend)
     {
-        bufptr = avpriv_mpv_find_start_code(bufptr, bufend, &_start_code);
+        bufptr = find_start_code(bufptr, bufend, &_start_code);
         bytes_left = bufend - bufptr;
         if ((_start_code & 0xffffff00) == 0x00000100)
         {
@@ -525,9 +597,9 @@ bool DTVRecorder::FindMPEG2Keyframes(const TSPacket* tspacket)
     {
         LOG(VB_RECORD, LOG_DEBUG, LOC + QString
             ("Keyframe @ %1 + %2 = %3")
-            .arg(ringBuffer->GetWritePosition())
+            .arg(GetWritePosition())
             .arg(_payload_buffer.size())
-            .arg(ringBuffer->GetWritePosition() + _payload_buffer.size()));
+            .arg(GetWritePosition() + _payload_buffer.size()));
 
         _last_keyframe_seen = _frames_seen_count;
         HandleKeyframe(0);
@@ -537,9 +609,9 @@ bool DTVRecorder::FindMPEG2Keyframes(const TSPacket* tspacket)
     {
         LOG(VB_RECORD, LOG_DEBUG, LOC + QString
             ("Frame @ %1 + %2 = %3")
-            .arg(ringBuffer->GetWritePosition())
+            .arg(GetWritePosition())
             .arg(_payload_buffer.size())
-            .arg(ringBuffer->GetWritePosition() + _payload_buffer.size()));
+            .arg(GetWritePosition() + _payload_buffer.size()));
 
         _buffer_packets = false;  // We now know if it is a keyframe, or not
         _frames_seen_count++;
@@ -738,17 +810,26 @@ void DTVRecorder::HandleKeyframe(int64_t extra)
     if (!ringBuffer)
         return;
 
+    // Write out everything before the keyframe, this also makes
+    // sure it goes to the old file if the ringbuffer is switched.
+    FlushWriteBuffer();
+
     // Perform ringbuffer switch if needed.
     CheckForRingBufferSwitch();
 
     uint64_t frameNum = _frames_written_count;
-    _first_keyframe = (_first_keyframe < 0) ? frameNum : _first_keyframe;
+    if (_first_keyframe < 0)
+    {
+        _first_keyframe = frameNum;
+        if (tvrec)
+            tvrec->TuningPhaseDone("first keyframe", true);
+    }
 
     // Add key frame to position map
     positionMapLock.lock();
     if (!positionMap.contains(frameNum))
     {
-        int64_t startpos = ringBuffer->GetWritePosition() + extra;
+        int64_t startpos = GetWritePosition() + extra;
 
         // Don't put negative offsets into the database, they get munged into
         // MAX_INT64 - offset, which is an exceedingly large number, and
@@ -866,7 +947,7 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
 
         uint32_t bytes_used = m_h264_parser.addBytes
                               (tspacket->data() + i, TSPacket::kSize - i,
-                               ringBuffer->GetWritePosition());
+                               GetWritePosition());
         i += (bytes_used - 1);
 
         if (m_h264_parser.stateChanged())
@@ -891,9 +972,9 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
     {
         LOG(VB_RECORD, LOG_DEBUG, LOC + QString
             ("Keyframe @ %1 + %2 = %3 AU %4")
-            .arg(ringBuffer->GetWritePosition())
+            .arg(GetWritePosition())
             .arg(_payload_buffer.size())
-            .arg(ringBuffer->GetWritePosition() + _payload_buffer.size())
+            .arg(GetWritePosition() + _payload_buffer.size())
             .arg(m_h264_parser.keyframeAUstreamOffset()));
 
         _last_keyframe_seen = _frames_seen_count;
@@ -904,9 +985,9 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
     {
         LOG(VB_RECORD, LOG_DEBUG, LOC + QString
             ("Frame @ %1 + %2 = %3 AU %4")
-            .arg(ringBuffer->GetWritePosition())
+            .arg(GetWritePosition())
             .arg(_payload_buffer.size())
-            .arg(ringBuffer->GetWritePosition() + _payload_buffer.size())
+            .arg(GetWritePosition() + _payload_buffer.size())
             .arg(m_h264_parser.keyframeAUstreamOffset()));
 
         _buffer_packets = false;  // We now know if this is a keyframe
@@ -964,6 +1045,8 @@ void DTVRecorder::HandleH264Keyframe(void)
     {
         _first_keyframe = frameNum;
         startpos = 0;
+        if (tvrec)
+            tvrec->TuningPhaseDone("first keyframe", true);
     }
     else
         startpos = m_h264_parser.keyframeAUstreamOffset();
@@ -999,7 +1082,7 @@ void DTVRecorder::FindPSKeyFrames(const uint8_t *buffer, uint len)
 
         const uint8_t *tmp = bufptr;
         bufptr =
-            avpriv_mpv_find_start_code(bufptr + skip, bufend, &_start_code);
+            find_start_code(bufptr + skip, bufend, &_start_code);
         _audio_bytes_remaining = 0;
         _other_bytes_remaining = 0;
         _video_bytes_remaining -= std::min(
@@ -1127,16 +1210,12 @@ void DTVRecorder::FindPSKeyFrames(const uint8_t *buffer, uint len)
             // buffered packet[s] we have to write them first...
             if (!_payload_buffer.empty())
             {
-                if (ringBuffer)
-                {
-                    ringBuffer->Write(
-                        &_payload_buffer[0], _payload_buffer.size());
-                }
+                WriteToRingBuffer(
+                    &_payload_buffer[0], _payload_buffer.size());
                 _payload_buffer.clear();
             }
 
-            if (ringBuffer)
-                ringBuffer->Write(bufstart, (bufptr - bufstart));
+            WriteToRingBuffer(bufstart, (bufptr - bufstart));
 
             bufstart = bufptr;
         }
@@ -1321,8 +1400,7 @@ bool DTVRecorder::ProcessVideoTSPacket(const TSPacket &tspacket)
         if (_buffer_packets && _first_keyframe >= 0 && !_payload_buffer.empty())
         {
             // Flush the buffer
-            if (ringBuffer)
-                ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
+            WriteToRingBuffer(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
         }
 
@@ -1352,8 +1430,7 @@ bool DTVRecorder::ProcessAudioTSPacket(const TSPacket &tspacket)
         if (_buffer_packets && _first_keyframe >= 0 && !_payload_buffer.empty())
         {
             // Flush the buffer
-            if (ringBuffer)
-                ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
+            WriteToRingBuffer(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
         }
 
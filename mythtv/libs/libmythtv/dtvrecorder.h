@@ -97,6 +97,10 @@ class DTVRecorder :
     void HandleTimestamps(int stream_id, int64_t pts, int64_t dts);
 
     void BufferedWrite(const TSPacket &tspacket, bool insert = false);
+    void WriteToRingBuffer(const void *data, uint len);
+    void FlushWriteBuffer(void);
+    void UpdateLatestDataTime(uint packets);
+    int64_t GetWritePosition(void) const;
 
     // MPEG TS "audio only" support
     bool FindAudioKeyframes(const TSPacket *tspacket);
@@ -160,6 +164,13 @@ class DTVRecorder :
     bool                  _buffer_packets;
     vector<unsigned char> _payload_buffer;
 
+    // output coalescing buffer, see WriteToRingBuffer()
+    vector<unsigned char> _write_buffer;
+    uint                  _write_buffer_packets;
+    uint                  _write_buffer_writes;
+    MythTimer             _write_buffer_timer;
+    static const uint     kWriteBufferSize;
+
     // general recorder stuff
     mutable QMutex           _pid_lock;
     ProgramAssociationTable *_input_pat; ///< PAT on input side
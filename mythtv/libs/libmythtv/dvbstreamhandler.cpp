@@ -197,6 +197,8 @@ void DVBStreamHandler::RunTS(void)
 
     LOG(VB_RECORD, LOG_INFO, LOC + "RunTS(): begin");
 
+    vector<MPEGStreamData*> sdlist;
+
     fd_set fd_select_set;
     FD_ZERO(        &fd_select_set);
     FD_SET (dvr_fd, &fd_select_set);
@@ -263,9 +265,12 @@ void DVBStreamHandler::RunTS(void)
             continue;
         }
 
+        // Demux once for all the recorders sharing this stream
+        sdlist.clear();
         StreamDataList::const_iterator sit = _stream_data_list.begin();
         for (; sit != _stream_data_list.end(); ++sit)
-            remainder = sit.key()->ProcessData(buffer, len);
+            sdlist.push_back(sit.key());
+        remainder = MPEGStreamData::ProcessData(sdlist, buffer, len);
 
         _listener_lock.unlock();
 
@@ -122,13 +122,27 @@ EITFixUp::EITFixUp()
                         "NRK2s historiekveld|Detektimen|Nattkino|Filmklassiker|Film|Kortfilm|P.skemorg[eo]n|"
                         "Radioteatret|Opera|P2-Akademiet|Nyhetsmorg[eo]n i P2 og Alltid Nyheter:): (.+)"),
       m_noPremiere("\\s+-\\s+(Sesongpremiere|Premiere|premiere)!?$"),
-      m_Stereo("\\b\\(?[sS]tereo\\)?\\b")
+      m_Stereo("\\b\\(?[sS]tereo\\)?\\b"),
+      // The ISDB patterns contain full width characters, they are kept
+      // UTF-8 escaped because this file is Latin-1 encoded.
+      m_isdbTitlePrefix(QString::fromUtf8(
+          "^((\\[.{1,2}\\]|\xe3\x80\x90.\xe3\x80\x91|<[^>]+>|5[\\.\xef\xbc\x8e]1)+)")),
+      m_isdbTitleSuffix(QString::fromUtf8(
+          ".+(?:\xe3\x80\x9c[^\xe3\x80\x9c]+\xe3\x80\x9c)?.*(?:(?:-[^\\-]+-)|(?:\xe2\x88\x92[^\xe2\x88\x92]+\xe2\x88\x92))?.*"
+          "(((\\[.{1,2}\\])+|[#\xef\xbc\x83]\\d+|\\([#\xef\xbc\x83]?\\d+\\)|\xef\xbc\x88[#\xef\xbc\x83]?\\d+\xef\xbc\x89|"
+          "vol\\.\\d+|\\(?\xe7\xac\xac(?!.{1,3}\xe9\x83\xa8)|\xe6\x9c\x80\xe7\xb5\x82\xe5\x9b\x9e|"
+          "\xe3\x80\x8c(?![^\xe3\x80\x8d]+\xe3\x80\x8d(.?[<\xef\xbc\x9c]|.*[#\xef\xbc\x83\xe7\xac\xac]\\d+))|[<\xef\xbc\x9c\xe3\x80\x90\xe2\x96\xbd\xe2\x97\x86]).*)"),
+          Qt::CaseInsensitive)
 
 {
 }
 
 void EITFixUp::Fix(DBEventEIT &event) const
 {
+    // This must run before the generic subtitle/description shuffle
+    if (kFixISDB & event.fixup)
+        FixISDB(event);
+
     if (event.fixup)
     {
         if (event.subtitle == event.title)
@@ -1767,3 +1781,30 @@ void EITFixUp::FixNRK_DVBT(DBEventEIT &event) const
     }
 }
 
+/** \fn EITFixUp::FixISDB(DBEventEIT&) const
+ *  \brief Use this to split Japanese ISDB event names into title and
+ *         subtitle. Leading marks such as [Ji] or [Sai] and trailing
+ *         episode numbers, "Dai N Wa", quoted episode names etc. are
+ *         moved in front of the short event text in the subtitle.
+ */
+void EITFixUp::FixISDB(DBEventEIT &event) const
+{
+    QString prefix, suffix;
+
+    QRegExp tmpPrefix = m_isdbTitlePrefix;
+    if (tmpPrefix.indexIn(event.title) == 0)
+    {
+        prefix = tmpPrefix.cap(1);
+        event.title.remove(0, tmpPrefix.matchedLength());
+    }
+
+    QRegExp tmpSuffix = m_isdbTitleSuffix;
+    if (tmpSuffix.indexIn(event.title) != -1)
+    {
+        suffix = tmpSuffix.cap(1);
+        event.title.remove(suffix);
+    }
+
+    event.title    = event.title.trimmed();
+    event.subtitle = prefix + suffix + event.subtitle;
+}
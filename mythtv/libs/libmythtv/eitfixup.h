@@ -51,6 +51,7 @@ class EITFixUp
         kFixNO         = 0x10000,
         kFixNRK_DVBT   = 0x20000,
         kFixDish       = 0x40000,
+        kFixISDB       = 0x80000,
 
         // Early fixups
         kEFixForceISO8859_1  = 0x2000,
@@ -90,6 +91,7 @@ class EITFixUp
     void FixCategory(DBEventEIT &event) const;      // Generic Category fixes
     void FixNO(DBEventEIT &event) const;            // Norwegian DVB-S
     void FixNRK_DVBT(DBEventEIT &event) const;      // Norwegian NRK DVB-T
+    void FixISDB(DBEventEIT &event) const;          // Japan ISDB-T/S
 
     static QString AddDVBEITAuthority(uint chanid, const QString &id);
 
@@ -195,6 +197,8 @@ class EITFixUp
     const QRegExp m_noNRKCategories;
     const QRegExp m_noPremiere;
     const QRegExp m_Stereo;
+    const QRegExp m_isdbTitlePrefix;
+    const QRegExp m_isdbTitleSuffix;
 };
 
 #endif // EITFIXUP_H
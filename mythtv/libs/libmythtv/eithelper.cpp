@@ -12,6 +12,9 @@ using namespace std;
 #include "eitfixup.h"
 #include "eitcache.h"
 #include "mythdb.h"
+#include "mythcorecontext.h"
+#include "mythtimer.h"
+#include "channelutil.h"
 #include "atsctables.h"
 #include "dvbtables.h"
 #include "premieretables.h"
@@ -23,6 +26,7 @@ using namespace std;
 #include "compat.h" // for gmtime_r on windows.
 
 const uint EITHelper::kChunkSize = 20;
+const uint EITHelper::kBatchSize = 500;
 EITCache *EITHelper::eitcache = new EITCache();
 
 static uint get_chan_id_from_db(uint sourceid,
@@ -34,9 +38,12 @@ static void init_fixup(QMap<uint64_t,uint> &fix);
 #define LOC QString("EITHelper: ")
 
 EITHelper::EITHelper() :
+    chanid_primed(false),
+    chanid_generation(ChannelUtil::GetChannelTableGeneration()),
     eitfixup(new EITFixUp()),
     gps_offset(-1 * GPS_LEAP_SECONDS),
-    sourceid(0)
+    sourceid(0),
+    batch_updates(gCoreContext->GetNumSetting("EITBatchUpdates", 1))
 {
     init_fixup(fixup);
 }
@@ -69,40 +76,113 @@ uint EITHelper::ProcessEvents(void)
     if (!db_events.size())
         return 0;
 
+    MythTimer t;
+    t.start();
+
     MSqlQuery query(MSqlQuery::InitCon());
-    for (uint i = 0; (i < kChunkSize) && (db_events.size() > 0); i++)
+    if (batch_updates)
     {
-        DBEventEIT *event = db_events.dequeue();
+        QList<DBEventEIT*> events;
+        for (uint i = 0; (i < kBatchSize) && (db_events.size() > 0); i++)
+            events.push_back(db_events.dequeue());
         eitList_lock.unlock();
 
-        eitfixup->Fix(*event);
-
-        insertCount += event->UpdateDB(query, 1000);
+        insertCount += UpdateEventsDB(query, events);
 
-        delete event;
         eitList_lock.lock();
     }
+    else
+    {
+        for (uint i = 0; (i < kChunkSize) && (db_events.size() > 0); i++)
+        {
+            DBEventEIT *event = db_events.dequeue();
+            eitList_lock.unlock();
+
+            eitfixup->Fix(*event);
+
+            uint count = event->UpdateDB(query, 1000);
+            if (count)
+                AddUpdatedSource(event->chanid);
+            insertCount += count;
+
+            delete event;
+            eitList_lock.lock();
+        }
+    }
 
     if (!insertCount)
         return 0;
 
+    int msecs = max(t.elapsed(), 1);
+    QString rate = QString(" (%1 events/s)")
+        .arg((insertCount * 1000ULL) / msecs);
+
     if (incomplete_events.size() || unmatched_etts.size())
     {
         LOG(VB_EIT, LOG_INFO,
-            LOC + QString("Added %1 events -- complete(%2) "
-                          "incomplete(%3) unmatched(%4)")
-                .arg(insertCount).arg(db_events.size())
+            LOC + QString("Added %1 events%2 -- complete(%3) "
+                          "incomplete(%4) unmatched(%5)")
+                .arg(insertCount).arg(rate).arg(db_events.size())
                 .arg(incomplete_events.size()).arg(unmatched_etts.size()));
     }
     else
     {
         LOG(VB_EIT, LOG_INFO,
-            LOC + QString("Added %1 events").arg(insertCount));
+            LOC + QString("Added %1 events%2").arg(insertCount).arg(rate));
+    }
+
+    return insertCount;
+}
+
+/** \brief Fixes up and writes \a events to the DB, grouped by channel.
+ *
+ *  The events are deleted once written.
+ *  \return Returns number of events inserted into DB.
+ */
+uint EITHelper::UpdateEventsDB(MSqlQuery &query, QList<DBEventEIT*> &events)
+{
+    // keep the queue order within each channel, UpdateDBBatch() relies on it
+    QMap<uint, vector<const DBEvent*> > chan_events;
+    for (int i = 0; i < events.size(); i++)
+    {
+        eitfixup->Fix(*events[i]);
+        chan_events[events[i]->chanid].push_back(events[i]);
+    }
+
+    uint insertCount = 0;
+    QMap<uint, vector<const DBEvent*> >::const_iterator it;
+    for (it = chan_events.begin(); it != chan_events.end(); ++it)
+    {
+        uint count = DBEvent::UpdateDBBatch(query, it.key(), *it, 1000);
+        if (count)
+            AddUpdatedSource(it.key());
+        insertCount += count;
     }
 
+    while (!events.empty())
+        delete events.takeFirst();
+
     return insertCount;
 }
 
+/** \brief Returns the sources of the events written since the last call.
+ *
+ *  A 0 in the list means the source of some channel was not known.
+ */
+QList<uint> EITHelper::TakeUpdatedSources(void)
+{
+    QMutexLocker locker(&chanid_lock);
+    QList<uint> sources = updated_sources.keys();
+    updated_sources.clear();
+    return sources;
+}
+
+void EITHelper::AddUpdatedSource(uint chanid)
+{
+    QMutexLocker locker(&chanid_lock);
+    updated_sources[chanid_to_sourceid.value(chanid, 0)] = true;
+}
+
 void EITHelper::SetFixup(uint atsc_major, uint atsc_minor, uint eitfixup)
 {
     QMutexLocker locker(&eitList_lock);
@@ -130,7 +210,9 @@ void EITHelper::SetLanguagePreferences(const QStringList &langPref)
 void EITHelper::SetSourceID(uint _sourceid)
 {
     QMutexLocker locker(&eitList_lock);
+    QMutexLocker chanid_locker(&chanid_lock);
     sourceid = _sourceid;
+    PrimeChanIDs();
 }
 
 void EITHelper::AddEIT(uint atsc_major, uint atsc_minor,
@@ -233,30 +315,16 @@ static void parse_dvb_event_descriptors(desc_list_t list, uint fix,
 
     if (bestShortEvent)
     {
-        QRegExp pre_pattern(QString::fromUtf8("^((\\[.{1,2}\\]|【.】|<[^>]+>|5[\\.．]1)+)")); 
-        QRegExp suf_pattern(QString::fromUtf8(".+(?:〜[^〜]+〜)?.*(?:(?:-[^\\-]+-)|(?:−[^−]+−))?.*(((\\[.{1,2}\\])+|[#＃]\\d+|\\([#＃]?\\d+\\)|（[#＃]?\\d+）|vol\\.\\d+|\\(?第(?!.{1,3}部)|最終回|「(?![^」]+」(.?[<＜]|.*[#＃第]\\d+))|[<＜【▽◆]).*)"), Qt::CaseInsensitive); 
         ShortEventDescriptor sed(bestShortEvent, dvbkind);
         if (enc)
         {
             title    = sed.EventName(enc, enc_len);
-            pre_pattern.indexIn(title);
-            subtitle = pre_pattern.cap(1);
-            title    = title.remove(pre_pattern);
-            suf_pattern.indexIn(title);
-            subtitle += suf_pattern.cap(1);
-            title    = title.remove(suf_pattern.cap(1)).trimmed();
-            subtitle += sed.Text(enc, enc_len);
+            subtitle = sed.Text(enc, enc_len);
         }
         else
         {
             title    = sed.EventName();
-            pre_pattern.indexIn(title);
-            subtitle = pre_pattern.cap(1);
-            title    = title.remove(pre_pattern);
-            suf_pattern.indexIn(title);
-            subtitle += suf_pattern.cap(1);
-            title    = title.remove(suf_pattern.cap(1)).trimmed();
-            subtitle += sed.Text();
+            subtitle = sed.Text();
         }
     }
 
@@ -317,6 +385,8 @@ void EITHelper::AddEIT(const DVBEventInformationTable *eit)
                  (uint64_t)(eit->OriginalNetworkID() << 16) |
                   (uint64_t)eit->ServiceID());
     fix |= EITFixUp::kFixGenericDVB;
+    if (eit->DVBKindStatus() == kKindISDB)
+        fix |= EITFixUp::kFixISDB;
 
     uint chanid = GetChanID(eit->ServiceID(), eit->OriginalNetworkID(),
                             eit->TSID());
@@ -673,6 +743,93 @@ void EITHelper::CompleteEvent(uint atsc_major, uint atsc_minor,
                                      audio_properties, video_properties));
 }
 
+/** \brief Loads all the chanid mappings for the current source.
+ *
+ *  Once primed a lookup that misses the map is known not to be in the
+ *  channel table, so GetChanID() only has to go to the DB if this failed.
+ *  The map is reloaded when the source changes or ChannelUtil reports a
+ *  change to the channel table. chanid_lock must be held.
+ */
+void EITHelper::PrimeChanIDs(void)
+{
+    srv_to_chanid.clear();
+    chanid_to_sourceid.clear();
+    chanid_primed     = false;
+    chanid_generation = ChannelUtil::GetChannelTableGeneration();
+
+    if (!sourceid)
+        return;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(
+        "SELECT chanid, useonairguide, atsc_major_chan, atsc_minor_chan "
+        "FROM channel "
+        "WHERE sourceid = :SOURCEID");
+    query.bindValue(":SOURCEID", sourceid);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("Priming chanids 1", query);
+        return;
+    }
+
+    while (query.next())
+    {
+        uint64_t key;
+        key  = ((uint64_t) sourceid);
+        key |= ((uint64_t) query.value(3).toUInt()) << 16;
+        key |= ((uint64_t) query.value(2).toUInt()) << 32;
+
+        chanid_to_sourceid[query.value(0).toUInt()] = sourceid;
+
+        if (srv_to_chanid.contains(key))
+            continue;
+
+        srv_to_chanid[key] = (query.value(1).toBool()) ?
+            query.value(0).toInt() : -1;
+    }
+
+    // The DVB lookup falls back to a channel on another source carrying
+    // the same service, see get_chan_id_from_db()
+    query.prepare(
+        "SELECT chanid, useonairguide, channel.sourceid, "
+        "       serviceid, networkid, transportid "
+        "FROM channel, dtv_multiplex "
+        "WHERE channel.mplexid  = dtv_multiplex.mplexid");
+
+    if (!query.exec())
+    {
+        MythDB::DBError("Priming chanids 2", query);
+        srv_to_chanid.clear();
+        return;
+    }
+
+    QMap<uint64_t,bool> on_source;
+    while (query.next())
+    {
+        uint64_t key;
+        key  = ((uint64_t) sourceid);
+        key |= ((uint64_t) query.value(3).toUInt()) << 16;
+        key |= ((uint64_t) query.value(4).toUInt()) << 32;
+        key |= ((uint64_t) query.value(5).toUInt()) << 48;
+
+        chanid_to_sourceid[query.value(0).toUInt()] = query.value(2).toUInt();
+
+        if (on_source.value(key))
+            continue;
+
+        on_source[key]     = (query.value(2).toUInt() == sourceid);
+        srv_to_chanid[key] = (query.value(1).toBool()) ?
+            query.value(0).toInt() : -1;
+    }
+
+    chanid_primed = true;
+
+    LOG(VB_EIT, LOG_INFO, LOC + QString("Loaded %1 chanid mappings "
+                                        "for sourceid %2")
+            .arg(srv_to_chanid.size()).arg(sourceid));
+}
+
 uint EITHelper::GetChanID(uint atsc_major, uint atsc_minor)
 {
     uint64_t key;
@@ -680,13 +837,19 @@ uint EITHelper::GetChanID(uint atsc_major, uint atsc_minor)
     key |= ((uint64_t) atsc_minor) << 16;
     key |= ((uint64_t) atsc_major) << 32;
 
+    QMutexLocker locker(&chanid_lock);
+    if (chanid_generation != ChannelUtil::GetChannelTableGeneration())
+        PrimeChanIDs();
+
     ServiceToChanID::const_iterator it = srv_to_chanid.find(key);
     if (it != srv_to_chanid.end())
         return max(*it, 0);
 
+    if (chanid_primed)
+        return 0;
+
     uint chanid = get_chan_id_from_db(sourceid, atsc_major, atsc_minor);
-    if (chanid)
-        srv_to_chanid[key] = chanid;
+    srv_to_chanid[key] = (chanid) ? (int) chanid : -1;
 
     return chanid;
 }
@@ -699,13 +862,19 @@ uint EITHelper::GetChanID(uint serviceid, uint networkid, uint tsid)
     key |= ((uint64_t) networkid) << 32;
     key |= ((uint64_t) tsid)      << 48;
 
+    QMutexLocker locker(&chanid_lock);
+    if (chanid_generation != ChannelUtil::GetChannelTableGeneration())
+        PrimeChanIDs();
+
     ServiceToChanID::const_iterator it = srv_to_chanid.find(key);
     if (it != srv_to_chanid.end())
         return max(*it, 0);
 
+    if (chanid_primed)
+        return 0;
+
     uint chanid = get_chan_id_from_db(sourceid, serviceid, networkid, tsid);
-    if (chanid)
-        srv_to_chanid[key] = chanid;
+    srv_to_chanid[key] = (chanid) ? (int) chanid : -1;
 
     return chanid;
 }
@@ -7,6 +7,7 @@
 
 // Qt includes
 #include <QByteArray>
+#include <QList>
 #include <QMap>
 #include <QMutex>
 #include <QObject>
@@ -64,6 +65,7 @@ class EITHelper
 
     uint GetListSize(void) const;
     uint ProcessEvents(void);
+    QList<uint> TakeUpdatedSources(void);
 
     uint GetGPSOffset(void) const { return (uint) (0 - gps_offset); }
 
@@ -93,6 +95,10 @@ class EITHelper
   private:
     uint GetChanID(uint atsc_major, uint atsc_minor);
     uint GetChanID(uint serviceid, uint networkid, uint transportid);
+    void PrimeChanIDs(void);
+    void AddUpdatedSource(uint chanid);
+
+    uint UpdateEventsDB(MSqlQuery &query, QList<DBEventEIT*> &events);
 
     void CompleteEvent(uint atsc_major, uint atsc_minor,
                        const ATSCEvent &event,
@@ -100,7 +106,13 @@ class EITHelper
 
         //QListList_Events  eitList;      ///< Event Information Tables List
     mutable QMutex    eitList_lock; ///< EIT List lock
-    mutable ServiceToChanID srv_to_chanid;
+    QMutex            chanid_lock;  ///< Protects the chanid mappings
+    ServiceToChanID   srv_to_chanid;
+    QMap<uint,uint>   chanid_to_sourceid;
+    /// Sources of the events written since TakeUpdatedSources(), 0 if unknown
+    QMap<uint,bool>   updated_sources;
+    bool              chanid_primed;
+    uint              chanid_generation;
 
     EITFixUp               *eitfixup;
     static EITCache        *eitcache;
@@ -115,8 +127,13 @@ class EITHelper
 
     QMap<uint,uint>         languagePreferences;
 
+    /// Write events in per channel batches, see DBEvent::UpdateDBBatch()
+    bool                    batch_updates;
+
     /// Maximum number of DB inserts per ProcessEvents call.
     static const uint kChunkSize;
+    /// Maximum number of DB inserts per ProcessEvents call in batch mode.
+    static const uint kBatchSize;
 };
 
 #endif // EIT_HELPER_H
@@ -17,6 +17,7 @@
 #include "iso639.h"
 #include "mythdb.h"
 #include "tv_rec.h"
+#include "dvbdescriptors.h"
 
 #define LOC QString("EITScanner: ")
 #define LOC_ID QString("EITScanner (%1): ").arg(cardnum)
@@ -67,6 +68,30 @@ void EITScanner::TeardownAll(void)
     }
 }
 
+static QMutex    isdb_stats_lock;
+static uint      isdb_stats_count = 0;
+static MythTimer isdb_stats_timer;
+
+/// Logs the ISDB text decodes of all cards since the last report.
+static void log_isdb_decode_stats(void)
+{
+    QMutexLocker locker(&isdb_stats_lock);
+
+    uint count = ISDBTextDecoder::DecodeCount();
+    uint delta = count - isdb_stats_count;
+    int  msecs = isdb_stats_timer.isRunning() ? isdb_stats_timer.restart() : 0;
+    isdb_stats_count = count;
+    if (!isdb_stats_timer.isRunning())
+        isdb_stats_timer.start();
+
+    if (!delta || !msecs)
+        return;
+
+    LOG(VB_EIT, LOG_INFO, LOC +
+        QString("%1 ISDB text decodes by all cards (%2/s)")
+        .arg(delta).arg((delta * 1000ULL) / msecs));
+}
+
 /**
  *  \brief This runs the event loop for EITScanner until 'exitThread' is true.
  */
@@ -108,23 +133,23 @@ void EITScanner::run(void)
 
         // If there have been any new events and we haven't
         // seen any in a while, tell scheduler to run.
-        if (eitCount && (t.elapsed() > 60 * 1000))
+        if (eitCount && (t.elapsed() > 60 * 1000) && RescheduleRecordings())
         {
             LOG(VB_EIT, LOG_INFO,
                 LOC_ID + QString("Added %1 EIT Events").arg(eitCount));
+            log_isdb_decode_stats();
             eitCount = 0;
-            RescheduleRecordings();
         }
 
         if (activeScan && (MythDate::current() > activeScanNextTrig))
         {
             // if there have been any new events, tell scheduler to run.
-            if (eitCount)
+            if (eitCount && RescheduleRecordings())
             {
                 LOG(VB_EIT, LOG_INFO,
                     LOC_ID + QString("Added %1 EIT Events").arg(eitCount));
+                log_isdb_decode_stats();
                 eitCount = 0;
-                RescheduleRecordings();
             }
 
             if (activeScanNextChan == activeScanChannels.end())
@@ -168,26 +193,41 @@ void EITScanner::run(void)
 /** \fn EITScanner::RescheduleRecordings(void)
  *  \brief Tells scheduler about programming changes.
  *
+ *  The match is limited to the sources the new events were written to,
+ *  so the scheduler can tell when they changed nothing it had matched.
+ *
  *  This implements some very basic rate limiting. If a call is made
- *  to this within kMinRescheduleInterval of the last call it is ignored.
+ *  to this within kMinRescheduleInterval of the last call it returns
+ *  false, and the changes are kept for a later call.
  */
-void EITScanner::RescheduleRecordings(void)
+bool EITScanner::RescheduleRecordings(void)
 {
     if (!resched_lock.tryLock())
-        return;
+        return false;
 
     if (resched_next_time > MythDate::current())
     {
-        LOG(VB_EIT, LOG_INFO, LOC + "Rate limiting reschedules..");
+        LOG(VB_EIT, LOG_DEBUG, LOC + "Rate limiting reschedules..");
         resched_lock.unlock();
-        return;
+        return false;
     }
 
     resched_next_time =
         MythDate::current().addSecs(kMinRescheduleInterval);
     resched_lock.unlock();
 
-    ScheduledRecording::RescheduleMatch(0, 0, 0, QDateTime(), "EITScanner");
+    QList<uint> sourceids = eitHelper->TakeUpdatedSources();
+    if (sourceids.empty() || sourceids.contains(0))
+    {
+        ScheduledRecording::RescheduleMatch(0, 0, 0, QDateTime(),
+                                            "EITScanner");
+        return true;
+    }
+
+    for (int i = 0; i < sourceids.size(); i++)
+        ScheduledRecording::RescheduleMatch(0, sourceids[i], 0, QDateTime(),
+                                            "EITScanner");
+    return true;
 }
 
 /** \fn EITScanner::StartPassiveScan(ChannelBase*, EITSource*, bool)
@@ -46,7 +46,7 @@ class EITScanner : public QRunnable
   private:
     void TeardownAll(void);
     static void *SpawnEventLoop(void*);
-    static void RescheduleRecordings(void);
+    bool RescheduleRecordings(void);
 
     QMutex           lock;
     ChannelBase     *channel;
@@ -6,6 +6,10 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <fcntl.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#endif
 
 #include <QFileInfo>
 #include <QDir>
@@ -42,7 +46,7 @@ static int posix_fadvise(int, off_t, off_t, int) { return 0; }
 
 FileRingBuffer::FileRingBuffer(const QString &lfilename,
                                bool write, bool readahead, int timeout_ms)
-  : RingBuffer(kRingBuffer_File)
+  : RingBuffer(kRingBuffer_File), growthfd(-1)
 {
     startreadahead = readahead;
     safefilename = lfilename;
@@ -106,6 +110,8 @@ FileRingBuffer::~FileRingBuffer()
         fd2 = -1;
     }
 
+    CloseGrowthWatch();
+
     rwlock.unlock();
 }
 
@@ -207,6 +213,8 @@ bool FileRingBuffer::OpenFile(const QString &lfilename, uint retry_ms)
         fd2 = -1;
     }
 
+    CloseGrowthWatch();
+
     bool is_local = 
         (filename.left(4) != "/dev") &&
         ((filename.left(1) == "/") || QFile::exists(filename));
@@ -421,7 +429,7 @@ int FileRingBuffer::safe_read(int fd, void *data, uint sz)
     int ret;
     unsigned tot = 0;
     unsigned errcnt = 0;
-    unsigned zerocnt = 0;
+    MythTimer eoftimer;
 
     if (fd2 < 0)
     {
@@ -462,23 +470,85 @@ int FileRingBuffer::safe_read(int fd, void *data, uint sz)
             if (tot > 0)
                 break;
 
-            zerocnt++;
-
-            // 0.36 second timeout for livetvchain with usleep(60000),
+            // 0.36 second timeout for livetvchain,
             // or 2.4 seconds if it's a new file less than 30 minutes old.
-            if (zerocnt >= (livetvchain ? 6 : 40))
-            {
+            if (!eoftimer.isRunning())
+                eoftimer.start();
+            else if (eoftimer.elapsed() >= (livetvchain ? 360 : 2400))
                 break;
-            }
         }
         if (stopreads)
             break;
         if (tot < sz)
-            usleep(60000);
+            WaitForGrowth(60);
     }
     return tot;
 }
 
+/** \brief Waits up to timeout_ms for the file being read to grow.
+ *
+ *   On Linux inotify wakes us as soon as the writer writes to the file.
+ *   Otherwise, or when the file is written on another host where inotify
+ *   does not see the writes, this just sleeps for the timeout.
+ */
+void FileRingBuffer::WaitForGrowth(int timeout_ms)
+{
+#ifdef __linux__
+    if (growthfd == -1)
+    {
+        growthfd = inotify_init();
+        if (growthfd >= 0)
+        {
+            fcntl(growthfd, F_SETFL, O_NONBLOCK);
+            fcntl(growthfd, F_SETFD, FD_CLOEXEC);
+            if (inotify_add_watch(growthfd, filename.toLocal8Bit().constData(),
+                                  IN_MODIFY | IN_CLOSE_WRITE) < 0)
+            {
+                close(growthfd);
+                growthfd = -1;
+            }
+        }
+
+        if (growthfd < 0)
+        {
+            LOG(VB_FILE, LOG_INFO, LOC +
+                "Unable to watch the file with inotify, polling instead" + ENO);
+            growthfd = -2;
+        }
+        else
+        {
+            // Any write from now on wakes us, so first read again in
+            // case the file grew before the watch was added.
+            return;
+        }
+    }
+
+    if (growthfd >= 0)
+    {
+        struct pollfd pfd;
+        pfd.fd      = growthfd;
+        pfd.events  = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, timeout_ms) > 0)
+        {
+            char buf[4096];
+            while (read(growthfd, buf, sizeof(buf)) > 0)
+                continue;
+        }
+        return;
+    }
+#endif
+
+    usleep(timeout_ms * 1000);
+}
+
+void FileRingBuffer::CloseGrowthWatch(void)
+{
+    if (growthfd >= 0)
+        close(growthfd);
+    growthfd = -1;
+}
+
 /** \fn FileRingBuffer::safe_read(RemoteFile*, void*, uint)
  *  \brief Reads data from the RemoteFile.
  *
@@ -33,4 +33,12 @@ class MTV_PUBLIC FileRingBuffer : public RingBuffer
     }
     int safe_read(int fd, void *data, uint sz);
     int safe_read(RemoteFile *rf, void *data, uint sz);
+
+    void WaitForGrowth(int timeout_ms);
+    void CloseGrowthWatch(void);
+
+  private:
+    /// inotify descriptor watching the file while we wait for it to grow,
+    /// -1 until it is needed, -2 if inotify is unavailable.
+    int growthfd;                 // protected by rwlock
 };
@@ -182,8 +182,9 @@ HEADERS += mpeg/atsc_huffman.h
 HEADERS += mpeg/freesat_huffman.h   mpeg/freesat_tables.h
 HEADERS += mpeg/iso6937tables.h
 HEADERS += mpeg/tsstats.h           mpeg/streamlisteners.h
-HEADERS += mpeg/H264Parser.h
-HEADERS += mpeg/isdb_decode_text.h
+HEADERS += mpeg/H264Parser.h          mpeg/startcode.h
+HEADERS += mpeg/isdb_decode_text.h  mpeg/isdb_jisx0213_tables.h
+HEADERS += mpeg/psicache.h
 
 SOURCES += mpeg/tspacket.cpp        mpeg/pespacket.cpp
 SOURCES += mpeg/mpegtables.cpp      mpeg/atsctables.cpp
@@ -198,7 +199,8 @@ SOURCES += mpeg/dishdescriptors.cpp mpeg/premieredescriptors.cpp
 SOURCES += mpeg/atsc_huffman.cpp
 SOURCES += mpeg/freesat_huffman.cpp
 SOURCES += mpeg/iso6937tables.cpp
-SOURCES += mpeg/H264Parser.cpp
+SOURCES += mpeg/psicache.cpp
+SOURCES += mpeg/H264Parser.cpp        mpeg/startcode.cpp
 SOURCES += mpeg/isdb_decode_text.c
 
 # Channels, and the multiplexes that transmit them
@@ -498,9 +500,11 @@ using_backend {
     HEADERS += tv_rec.h
     HEADERS += recorderbase.h              DeviceReadBuffer.h
     HEADERS += dtvrecorder.h               recordingquality.h
+    HEADERS += positionmapwriter.h
     SOURCES += tv_rec.cpp
     SOURCES += recorderbase.cpp            DeviceReadBuffer.cpp
     SOURCES += dtvrecorder.cpp             recordingquality.cpp
+    SOURCES += positionmapwriter.cpp
 
     # Import recorder
     HEADERS += importrecorder.h
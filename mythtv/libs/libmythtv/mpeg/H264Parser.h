@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include "mythconfig.h"
 #include "compat.h" // for uint on Darwin, MinGW
+#include "mythtvexp.h"
 
 #ifndef INT_BIT
 #define INT_BIT (CHAR_BIT * sizeof(int))
@@ -48,7 +49,7 @@ extern "C" {
 #include "libavcodec/get_bits.h"
 }
 
-class H264Parser {
+class MTV_PUBLIC H264Parser {
   public:
 
     enum {
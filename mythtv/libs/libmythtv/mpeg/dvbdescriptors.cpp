@@ -5,6 +5,7 @@
 // Qt headers
 #include <QTextCodec>
 #include <QCoreApplication>
+#include <QThreadStorage>
 
 // MythTV headers
 #include "dvbdescriptors.h"
@@ -48,8 +49,107 @@ static QString decode_iso6937(const unsigned char *buf, uint length)
     return result;
 }
 
+class ISDBThreadContext
+{
+  public:
+    ISDBThreadContext() : type(ISDB_ARIB)
+    {
+        handle[ISDB_ARIB] = (IsdbDecode)NULL;
+        handle[ISDB_ABNT] = (IsdbDecode)NULL;
+    }
+    ~ISDBThreadContext()
+    {
+        if (handle[ISDB_ARIB] != (IsdbDecode)NULL)
+            isdb_decode_close(handle[ISDB_ARIB]);
+        if (handle[ISDB_ABNT] != (IsdbDecode)NULL)
+            isdb_decode_close(handle[ISDB_ABNT]);
+    }
+
+    ISDBTYPE   type;
+    IsdbDecode handle[2];
+};
+
+static QThreadStorage<ISDBThreadContext*> isdb_context;
+
+static ISDBThreadContext *get_isdb_context(void)
+{
+    if (!isdb_context.hasLocalData())
+        isdb_context.setLocalData(new ISDBThreadContext());
+    return isdb_context.localData();
+}
+
+QAtomicInt ISDBTextDecoder::s_decode_count(0);
+
+/** \fn ISDBTextDecoder::Get(void)
+ *  \brief Returns this thread's decoder for the current ISDB flavour,
+ *         opening it on first use. The handle stays valid until the
+ *         thread exits.
+ */
+IsdbDecode ISDBTextDecoder::Get(void)
+{
+    return Get(ThreadType());
+}
+
+/// \brief Returns this thread's decoder for the given ISDB flavour.
+IsdbDecode ISDBTextDecoder::Get(ISDBTYPE type)
+{
+    ISDBThreadContext *ctx = get_isdb_context();
+    if (ctx->handle[type] == (IsdbDecode)NULL)
+        ctx->handle[type] = isdb_decode_open(type);
+    return ctx->handle[type];
+}
+
+void ISDBTextDecoder::SetThreadType(ISDBTYPE type)
+{
+    get_isdb_context()->type = type;
+}
+
+ISDBTYPE ISDBTextDecoder::ThreadType(void)
+{
+    return get_isdb_context()->type;
+}
+
+/** \fn ISDBTextDecoder::TypeForNetwork(uint)
+ *  \brief Japanese (ARIB) networks use the IDs assigned in ARIB TR-B14
+ *         and TR-B15, everything else is taken to be SBTVD (ABNT).
+ *         An unknown network (0) is treated as ARIB.
+ */
+ISDBTYPE ISDBTextDecoder::TypeForNetwork(uint original_network_id)
+{
+    if (original_network_id == 0)
+        return ISDB_ARIB;
+    // BS, 110 degree CS and SKY PerfecTV!
+    if (original_network_id <= 0x000A)
+        return ISDB_ARIB;
+    // Terrestrial digital broadcasting
+    if (original_network_id >= 0x7880 && original_network_id <= 0x7FE8)
+        return ISDB_ARIB;
+    return ISDB_ABNT;
+}
+
+void ISDBTextDecoder::CountDecode(void)
+{
+    s_decode_count.fetchAndAddRelaxed(1);
+}
+
+/// Number of ISDB strings decoded since startup, all threads.
+uint ISDBTextDecoder::DecodeCount(void)
+{
+    return (uint) s_decode_count.fetchAndAddRelaxed(0);
+}
+
 static QString decode_text(const unsigned char *buf, uint length);
 
+static QString isdb_decode_string(IsdbDecode handle, const unsigned char *src,
+                                  uint raw_length, unsigned char *buf,
+                                  uint buf_size)
+{
+    ISDBTextDecoder::CountDecode();
+    uint len = isdb_decode_text(handle, src, raw_length, buf, buf_size);
+    return QString::fromUtf8((const char *)buf, (int)len).
+        replace(QString("\n"), QString(" "));
+}
+
 // Decode a text string according to ETSI EN 300 468 Annex A
 QString DVBDescriptor::dvb_decode_text(const unsigned char *src, uint raw_length,
                         const unsigned char *encoding_override,
@@ -61,11 +161,8 @@ QString DVBDescriptor::dvb_decode_text(const unsigned char *src, uint raw_length
     if (_dvbkind == kKindISDB)
     {
         unsigned char buf[4096 * 6];
-        unsigned int len;
-        len = isdb_decode_text(hisdbdecode, src, (unsigned int)raw_length,
-                               buf, (unsigned int)sizeof(buf));
-        return QString::fromUtf8((const char *)buf, (int)len).
-           replace(QString("\n"), QString(" ")); 
+        return isdb_decode_string(hisdbdecode, src, raw_length,
+                                  buf, sizeof(buf));
     }
 
     if (src[0] == 0x1f)
@@ -114,6 +211,20 @@ QString DVBDescriptor::dvb_decode_text(const unsigned char *src, uint raw_length
     return sStr;
 }
 
+/// \brief Like dvb_decode_text(), but ISDB text is decoded with the
+///        given flavour rather than the thread's.
+QString DVBDescriptor::dvb_decode_text(const unsigned char *src,
+                                       uint raw_length,
+                                       ISDBTYPE isdbtype) const
+{
+    if (!raw_length || _dvbkind != kKindISDB)
+        return dvb_decode_text(src, raw_length);
+
+    unsigned char buf[4096 * 6];
+    return isdb_decode_string(ISDBTextDecoder::Get(isdbtype), src, raw_length,
+                              buf, sizeof(buf));
+}
+
 static QString decode_text(const unsigned char *buf, uint length)
 {
     // Only some of the QTextCodec calls are reentrant.
@@ -187,11 +298,8 @@ QString DVBDescriptor::dvb_decode_short_name(const unsigned char *src, uint raw_
     if (_dvbkind == kKindISDB)
     {
         unsigned char buf[50 * 6];
-        unsigned int len;
-        len = isdb_decode_text(hisdbdecode, src, (unsigned int)raw_length,
-                               buf, (unsigned int)sizeof(buf));
-        return QString::fromUtf8((const char *)buf, (int)len).
-           replace(QString("\n"), QString(" ")); 
+        return isdb_decode_string(hisdbdecode, src, raw_length,
+                                  buf, sizeof(buf));
     }
 
     if (src[0] == 0x11) 
@@ -230,6 +338,20 @@ QString DVBDescriptor::dvb_decode_short_name(const unsigned char *src, uint raw_
     return sStr;
 }
 
+/// \brief Like dvb_decode_short_name(), but ISDB text is decoded with the
+///        given flavour rather than the thread's.
+QString DVBDescriptor::dvb_decode_short_name(const unsigned char *src,
+                                             uint raw_length,
+                                             ISDBTYPE isdbtype) const
+{
+    if (raw_length > 50 || _dvbkind != kKindISDB)
+        return dvb_decode_short_name(src, raw_length);
+
+    unsigned char buf[50 * 6];
+    return isdb_decode_string(ISDBTextDecoder::Get(isdbtype), src, raw_length,
+                              buf, sizeof(buf));
+}
+
 static uint maxPriority(const QMap<uint,uint> &langPrefs)
 {
     uint max_pri = 0;
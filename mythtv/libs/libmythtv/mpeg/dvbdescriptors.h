@@ -3,6 +3,7 @@
 #ifndef _DVB_DESCRIPTORS_H_
 #define _DVB_DESCRIPTORS_H_
 
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QMutex>
 #include <QString>
@@ -37,34 +38,46 @@
 
 static QString coderate_inner(uint coderate);
 
+/** \class ISDBTextDecoder
+ *  \brief Long-lived ARIB STD-B24 / ABNT NBR 15606 text decoder handles.
+ *
+ *  Opening a decoder is expensive, so each thread keeps one handle per
+ *  ISDB flavour for its whole lifetime. The flavour used by descriptors
+ *  created on a thread is chosen once from the original network ID by
+ *  the DVBStreamData feeding that thread. Code running on other threads
+ *  must pass the flavour explicitly, e.g. to ServiceName(ISDBTYPE).
+ */
+class MTV_PUBLIC ISDBTextDecoder
+{
+  public:
+    static IsdbDecode Get(void);
+    static IsdbDecode Get(ISDBTYPE type);
+    static void SetThreadType(ISDBTYPE type);
+    static ISDBTYPE ThreadType(void);
+    static ISDBTYPE TypeForNetwork(uint original_network_id);
+
+    static void CountDecode(void);
+    static uint DecodeCount(void);
+
+  private:
+    static QAtomicInt s_decode_count;
+};
+
 class DVBDescriptor : public MPEGDescriptor
 {
   public:
     DVBDescriptor(const unsigned char *data, DVBKind dvbkind = kKindUnknown, int len = 300, uint tag = NULL)
-        : MPEGDescriptor(data, len, tag), _dvbkind(dvbkind)
+        : MPEGDescriptor(data, len, tag), _dvbkind(dvbkind),
+          hisdbdecode((IsdbDecode)NULL)
     {
         if ((len < 2) || (int(DescriptorLength()) + 2) > len)
             _data = NULL;
         else if (DescriptorTag() != tag)
             _data = NULL;
-        if (_dvbkind == kKindISDB) {
-            QDateTime dt1 = QDateTime::currentDateTime();
-            QDateTime dt2 = dt1.toUTC();
-            dt1.setTimeSpec(Qt::UTC);
- 
-            int offset = dt2.secsTo(dt1) / 3600;
-            if (9 == offset)
-                hisdbdecode = isdb_decode_open(ISDB_ARIB);
-            else
-                hisdbdecode = isdb_decode_open(ISDB_ABNT);
-         }
-         else
-            hisdbdecode = (IsdbDecode)NULL;
-    }
-    virtual ~DVBDescriptor() {
-        if (hisdbdecode != (IsdbDecode)NULL)
-            isdb_decode_close(hisdbdecode);
+        if (_dvbkind == kKindISDB)
+            hisdbdecode = ISDBTextDecoder::Get();
     }
+    virtual ~DVBDescriptor() { }
 
     static const unsigned char* FindBestMatch(
         const desc_list_t &parsed, uint desc_tag, QMap<uint,uint> &langPref, DVBKind dvbkind);
@@ -74,13 +87,17 @@ class DVBDescriptor : public MPEGDescriptor
     QString dvb_decode_text(const unsigned char *src, uint length,
                             const unsigned char *encoding_override = NULL,
                             uint encoding_override_length = 0) const;
+    QString dvb_decode_text(const unsigned char *src, uint length,
+                            ISDBTYPE isdbtype) const;
     QString dvb_decode_short_name(const unsigned char *src, uint raw_length) const;
+    QString dvb_decode_short_name(const unsigned char *src, uint raw_length,
+                                  ISDBTYPE isdbtype) const;
 
     virtual QString toString(void) const;
   protected:
     const DVBKind _dvbkind;
   private:
-    IsdbDecode hisdbdecode;
+    IsdbDecode hisdbdecode; ///< owned by ISDBTextDecoder, not by us
 };
 
 #define byteBCDH2int(i) (i >> 4)
@@ -1590,11 +1607,21 @@ class ServiceDescriptor : public DVBDescriptor
         return dvb_decode_text(_data + 5 + ServiceProviderNameLength(),
                                ServiceNameLength());
     }
+    QString ServiceName(ISDBTYPE isdbtype) const
+    {
+        return dvb_decode_text(_data + 5 + ServiceProviderNameLength(),
+                               ServiceNameLength(), isdbtype);
+    }
     QString ServiceShortName(void) const
     {
         return dvb_decode_short_name(_data + 5 + ServiceProviderNameLength(),
                                      ServiceNameLength());
     }
+    QString ServiceShortName(ISDBTYPE isdbtype) const
+    {
+        return dvb_decode_short_name(_data + 5 + ServiceProviderNameLength(),
+                                     ServiceNameLength(), isdbtype);
+    }
     bool IsDTV(void) const
         { return ServiceDescriptorMapping(ServiceType()).IsDTV(); }
     bool IsDigitalAudio(void) const
@@ -20,6 +20,7 @@ DVBStreamData::DVBStreamData(uint desired_netid,  uint desired_tsid,
     : MPEGStreamData(desired_program, cacheTables),
       _desired_netid(desired_netid), _desired_tsid(desired_tsid),
       _dvbkind(dvbkind),
+      _isdbtype(ISDBTextDecoder::TypeForNetwork(desired_netid)),
       _dvb_eit_dishnet_long(false),
       _nit_version(-2), _nito_version(-2)
 {
@@ -184,6 +185,7 @@ void DVBStreamData::Reset(uint desired_netid, uint desired_tsid,
 
     _desired_netid = desired_netid;
     _desired_tsid  = desired_tsid;
+    _isdbtype      = ISDBTextDecoder::TypeForNetwork(desired_netid);
 
     SetVersionNIT(-1,0);
     _sdt_versions.clear();
@@ -225,6 +227,15 @@ void DVBStreamData::Reset(uint desired_netid, uint desired_tsid,
  */
 bool DVBStreamData::HandleTables(uint pid, const PSIPTable &psip)
 {
+    if (_dvbkind == kKindISDB)
+    {
+        // When scanning we don't know the network up front, so take
+        // the ISDB flavour from the first actual NIT we see.
+        if (!_desired_netid && TableID::NIT == psip.TableID())
+            _isdbtype = ISDBTextDecoder::TypeForNetwork(psip.TableIDExtension());
+        ISDBTextDecoder::SetThreadType(_isdbtype);
+    }
+
     if (MPEGStreamData::HandleTables(pid, psip))
         return true;
 
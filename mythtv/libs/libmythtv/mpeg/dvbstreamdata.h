@@ -4,6 +4,7 @@
 #define DVBSTREAMDATA_H_
 
 #include "mpegstreamdata.h"
+#include "isdb_decode_text.h"
 #include "mythtvexp.h"
 
 typedef NetworkInformationTable* nit_ptr_t;
@@ -216,6 +217,8 @@ class MTV_PUBLIC DVBStreamData : virtual public MPEGStreamData
     uint                      _desired_netid;
     uint                      _desired_tsid;
     DVBKind                   _dvbkind;
+    /// ARIB or ABNT text coding, chosen from the network ID
+    ISDBTYPE                  _isdbtype;
 
     /// Decode DishNet's long-term DVB EIT
     bool                      _dvb_eit_dishnet_long;
@@ -1,7 +1,5 @@
 #include <stdlib.h>
 #include <assert.h>
-#include <errno.h>
-#include <iconv.h>
 
 /*#define USE_UNICODE_SQUAREDCJK	(1)*/
 /*#define DEBUG	(1)*/
@@ -14,12 +12,10 @@ pthread_mutex_t mut = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
 #include "isdb_decode_text.h"
+#include "isdb_jisx0213_tables.h"
 
 typedef struct {
 	ISDBTYPE isdb;
-
-	/* for ARIB STD-B24 8bit-character code */
-	iconv_t cd;
 } _IsdbDecode;
 
 typedef struct {
@@ -1107,9 +1103,6 @@ IsdbDecode isdb_decode_open(ISDBTYPE isdb)
 
 	_handle->isdb = isdb;
 
-	_handle->cd = iconv_open("UTF-8", "ISO-2022-JP-3");
-	assert((iconv_t)0 <= _handle->cd);
-
 	return (IsdbDecode)_handle;
 }
 
@@ -1120,7 +1113,6 @@ void isdb_decode_close(IsdbDecode handle)
 	_handle = (_IsdbDecode *)handle;
 	assert(NULL != _handle);
 
-	iconv_close(_handle->cd);
 	free(_handle);
 }
 
@@ -1387,22 +1379,97 @@ static void convert_str_replacement_character(OBUF *obuf)
 	}
 }
 
-static void convert_str_kanji(iconv_t cd, GLR glr, CODESET cs,
+static void convert_str_ucs(unsigned int ucs, OBUF *obuf)
+{
+	if (ucs < 0x80) {
+		assert(OBUF_isremain(obuf));
+		OBUF_put(obuf, (unsigned char)ucs);
+	}
+	else if (ucs < 0x800) {
+		assert(OBUF_isremainn(obuf, 2));
+		OBUF_put(obuf, (unsigned char)(0xc0 | (ucs >> 6)));
+		OBUF_put(obuf, (unsigned char)(0x80 | (ucs & 0x3f)));
+	}
+	else if (ucs < 0x10000) {
+		assert(OBUF_isremainn(obuf, 3));
+		OBUF_put(obuf, (unsigned char)(0xe0 | (ucs >> 12)));
+		OBUF_put(obuf, (unsigned char)(0x80 | ((ucs >> 6) & 0x3f)));
+		OBUF_put(obuf, (unsigned char)(0x80 | (ucs & 0x3f)));
+	}
+	else {
+		assert(OBUF_isremainn(obuf, 4));
+		OBUF_put(obuf, (unsigned char)(0xf0 | (ucs >> 18)));
+		OBUF_put(obuf, (unsigned char)(0x80 | ((ucs >> 12) & 0x3f)));
+		OBUF_put(obuf, (unsigned char)(0x80 | ((ucs >> 6) & 0x3f)));
+		OBUF_put(obuf, (unsigned char)(0x80 | (ucs & 0x3f)));
+	}
+}
+
+static void convert_str_code(const unsigned char *code, OBUF *obuf)
+{
+	while (*code) {
+		assert(OBUF_isremain(obuf));
+		OBUF_put(obuf, *code++);
+	}
+}
+
+/* One 2-byte character of the kanji, JIS kanji plane 1 or 2 sets. */
+static void convert_str_kanji1(CODESET cs, unsigned char c1, unsigned char c2,
+							   OBUF *obuf)
+{
+	int row, cell;
+	unsigned int ucs;
+
+	row = c1 - 0x20;
+	cell = c2 - 0x20;
+	if (row < 1 || row > 94 || cell < 1 || cell > 94) {
+		convert_str_replacement_character(obuf);
+		return;
+	}
+
+	if (CJkanji2 == cs) {
+		ucs = jisx0213_plane2[(row - 1) * 94 + (cell - 1)];
+	}
+	else if (Ckanji == cs && ISADDITIONAL_KANJI(row)) {
+		/* ARIB STD-B24 additional kanji (gaiji) */
+		convert_str_code((const unsigned char *)
+						 codeset_Additional_symbols85[row - 85][cell - 1],
+						 obuf);
+		return;
+	}
+	else if (Ckanji == cs && 1 == row && 29 == cell) {
+		/* JIS X 0208 maps the horizontal bar differently from 0213 */
+		ucs = 0x2015;
+	}
+	else {
+		/* JIS X 0208 is a subset of JIS X 0213 plane 1 */
+		ucs = jisx0213_plane1[(row - 1) * 94 + (cell - 1)];
+	}
+
+	if (0 == ucs) {
+		convert_str_replacement_character(obuf);
+	}
+	else if (ucs & 0x80000000) {
+		/* base character + combining character */
+		convert_str_ucs((ucs >> 16) & 0x7fff, obuf);
+		convert_str_ucs(ucs & 0xffff, obuf);
+	}
+	else {
+		convert_str_ucs(ucs, obuf);
+	}
+}
+
+static void convert_str_kanji(GLR glr, CODESET cs,
 							  GSET ss, unsigned char c,
 							  IBUF *ibuf, OBUF *obuf)
 {
 	int row, cell;
-	const unsigned char *code;
 	unsigned char c1;
-	char buf[3 + 1024 * 2], *p;
-	size_t size, left, rslt;
 
 	if (!IBUF_isremain(ibuf))
 		return;
 
-	p = buf;
-	switch (cs) {
-	case Ckanji:
+	if (Ckanji == cs) {
 		row = c - 0x20;
 		if (ISADDITIONAL_SYMBOLS(row)) {
 			/* Additional symbols */
@@ -1414,42 +1481,20 @@ static void convert_str_kanji(iconv_t cd, GLR glr, CODESET cs,
 				convert_str_replacement_character(obuf);
 			}
 
-			code = (const unsigned char *)codeset_Additional_symbols90[row - 90][cell - 1];
-			while (*code) {
-				assert(OBUF_isremain(obuf));
-				OBUF_put(obuf, *code++);
-			}
+			convert_str_code((const unsigned char *)
+							 codeset_Additional_symbols90[row - 90][cell - 1],
+							 obuf);
 			return;
 		}
-		*p++ = ESC;
-		*p++ = '$';
-		*p++ = 'B';
-		break;
-
-	case CJkanji1:
-		*p++ = ESC;
-		*p++ = '$';
-		*p++ = '(';
-		*p++ = 'Q';
-		break;
-
-	case CJkanji2:
-		*p++ = ESC;
-		*p++ = '$';
-		*p++ = '(';
-		*p++ = 'P';
-		break;
-
-	default:
+	}
+	else if (CJkanji1 != cs && CJkanji2 != cs) {
 		return;
 	}
 
-	*p++ = (char)c;
-	*p++ = (char)(IBUF_get(ibuf) & 0x7f);
+	convert_str_kanji1(cs, c, (unsigned char)(IBUF_get(ibuf) & 0x7f), obuf);
 	if (Gnull == ss) {
 		/* Locking shift */
-		while (IBUF_isremainn(ibuf, 1) &&
-			   p < buf + sizeof(buf)) {
+		while (IBUF_isremainn(ibuf, 1)) {
 			c1 = IBUF_geti(ibuf, 0);
 			if (GL == glr && !ISGL(c1))
 				break;
@@ -1464,20 +1509,14 @@ static void convert_str_kanji(iconv_t cd, GLR glr, CODESET cs,
 				}
 			}
 
-			*p++ = (char)(IBUF_get(ibuf) & 0x7f);
-			*p++ = (char)(IBUF_get(ibuf) & 0x7f);
+			c1 = (unsigned char)(IBUF_get(ibuf) & 0x7f);
+			convert_str_kanji1(cs, c1,
+							   (unsigned char)(IBUF_get(ibuf) & 0x7f), obuf);
 		}
-
 	}
 	else {
 		/* Single shift */
 	}
-	size = p - buf;
-	p = &buf[0];
-	left = (size_t)OBUF_putleft(obuf);
-	rslt = iconv(cd, &p, &size,
-				 (char **)OBUF_putp(obuf), &left);
-	assert(!((size_t)(-1) == rslt && E2BIG == errno));
 }
 
 static void convert_str_alpha(unsigned char c1, OBUF *obuf)
@@ -1567,7 +1606,7 @@ static void convert_str_special(unsigned char c1, OBUF *obuf)
 	}
 }
 
-static void convert_str_codeset(iconv_t cd, GLR glr, CODESET cs,
+static void convert_str_codeset(GLR glr, CODESET cs,
 								GSET ss, unsigned char c,
 								IBUF *ibuf, OBUF *obuf)
 {
@@ -1577,7 +1616,7 @@ static void convert_str_codeset(iconv_t cd, GLR glr, CODESET cs,
 	case Ckanji:
 	case CJkanji1:
 	case CJkanji2:
-		convert_str_kanji(cd, glr, cs, ss, c, ibuf, obuf);
+		convert_str_kanji(glr, cs, ss, c, ibuf, obuf);
 		break;
 
 	case Calpha:
@@ -1754,7 +1793,7 @@ unsigned int isdb_decode_text(IsdbDecode handle,
 		if (c < 0x80) {
 			if (ISGL(c)) {
 				getcodeset(GL, &si, &cs, &ss);
-				convert_str_codeset(_handle->cd, GL, cs, ss, c, &ibuf, &obuf);
+				convert_str_codeset(GL, cs, ss, c, &ibuf, &obuf);
 			}
 			else if (c == SP ||
 					 c == APD) {
@@ -1768,7 +1807,7 @@ unsigned int isdb_decode_text(IsdbDecode handle,
 		else {
 			if (ISGR(c)) {
 				getcodeset(GR, &si, &cs, &ss);
-				convert_str_codeset(_handle->cd, GR, cs, ss, (c & 0x7f), &ibuf, &obuf);
+				convert_str_codeset(GR, cs, ss, (c & 0x7f), &ibuf, &obuf);
 			}
 			else {
 				skip_cs1(c, &ibuf);
@@ -14,6 +14,7 @@ using namespace std;
 #include "mpegstreamdata.h"
 #include "mpegtables.h"
 #include "ringbuffer.h"
+#include "psicache.h"
 #include "mpegtables.h"
 
 #include "atscstreamdata.h"
@@ -70,6 +71,7 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, bool cacheTables)
       _eit_helper(NULL), _eit_rate(0.0f),
       _listening_disabled(false),
       _encryption_lock(QMutex::Recursive), _listener_lock(QMutex::Recursive),
+      _seeded_mplexid(0), _seeded_program(0), _seeded_stale(false),
       _cache_tables(cacheTables), _cache_lock(QMutex::Recursive),
       // Single program stuff
       _desired_program(desiredProgram),
@@ -84,6 +86,7 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, bool cacheTables)
       _invalid_pat_seen(false), _invalid_pat_warning(false)
 {
     memset(_si_time_offsets, 0, sizeof(_si_time_offsets));
+    memset(_pid_flags, 0, sizeof(_pid_flags));
 
     AddListeningPID(MPEG_PAT_PID);
     AddListeningPID(MPEG_CAT_PID);
@@ -91,6 +94,8 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, bool cacheTables)
 
 MPEGStreamData::~MPEGStreamData()
 {
+    LOG(VB_SIPARSER, LOG_DEBUG, _ts_stats.toString());
+
     Reset(-1);
     SetPATSingleProgram(NULL);
     SetPMTSingleProgram(NULL);
@@ -198,6 +203,14 @@ void MPEGStreamData::Reset(int desiredProgram)
     _pmt_version.clear();
     _pmt_section_seen.clear();
 
+    {
+        QMutexLocker locker(&_seeded_lock);
+        _seeded_crc.clear();
+        _seeded_pat.clear();
+        _seeded_pmt.clear();
+        _seeded_stale = false;
+    }
+
     {
         QMutexLocker locker(&_cache_lock);
 
@@ -218,6 +231,7 @@ void MPEGStreamData::Reset(int desiredProgram)
     }
 
     ResetDecryptionMonitoringState();
+    RebuildPIDFlags();
 
     AddListeningPID(MPEG_PAT_PID);
     AddListeningPID(MPEG_CAT_PID);
@@ -367,6 +381,20 @@ PSIPTable* MPEGStreamData::AssemblePSIP(const TSPacket* tspacket,
 
     const unsigned char* pesdata = tspacket->data() + offset;
     const int pes_length = (pesdata[2] & 0x0f) << 8 | pesdata[3];
+
+    // Drop sections we have already seen before copying them or checking
+    // their CRC, unless another section follows in this packet.
+    const int section_length = pes_length + 3;
+    const bool last_section =
+        ((pes_length + offset + extra_offset) > 188) ||
+        (offset + section_length + 1 >= (int) TSPacket::kSize) ||
+        (pesdata[section_length + 1] == 0xff);
+    if (last_section && IsRedundantSectionStart(tspacket, offset))
+    {
+        moreTablePackets = false;
+        return 0;
+    }
+
     if ((pes_length + offset + extra_offset) > 188)
     {
         SavePartialPSIP(tspacket->PID(), new PSIPTable(*tspacket));
@@ -649,6 +677,8 @@ bool MPEGStreamData::CreatePMTSingleProgram(const ProgramMapTable &pmt)
     for (uint i = 0; i < dataPIDs.size(); i++)
         AddWritingPID(dataPIDs[i]);
 
+    RebuildPIDFlags();
+
     // Timebase
     int pcrpidIndex = pmt.FindPID(pmt.PCRPID());
     if (pcrpidIndex < 0)
@@ -681,6 +711,42 @@ bool MPEGStreamData::CreatePMTSingleProgram(const ProgramMapTable &pmt)
     return true;
 }
 
+/** \brief Returns true if the section starting at offset in tspacket
+ *         has already been seen, judging only by its header.
+ *
+ *   This lets AssemblePSIP() skip the allocation, copy and CRC check for
+ *   tables that are resent unchanged many times a second, such as the
+ *   EIT, SDT and NIT carousels. PAT and PMT repeats are always assembled
+ *   since ProcessTSPacket() uses them for the single program heartbeat.
+ */
+bool MPEGStreamData::IsRedundantSectionStart(
+    const TSPacket *tspacket, int offset)
+{
+    // table_id through last_section_number must be in this packet
+    if (offset + 1 + 8 > (int) TSPacket::kSize)
+        return false;
+
+    const unsigned char *section = tspacket->data() + offset + 1;
+    const uint table_id = section[0];
+
+    // only sections using the long syntax carry a version number
+    if (!(section[1] & 0x80))
+        return false;
+
+    if (TableID::PAT == table_id || TableID::PMT == table_id)
+        return false;
+
+    const PSIPTable psip = PSIPTable::ViewHeader(*tspacket);
+    if (IsRedundant(tspacket->PID(), psip))
+    {
+        _ts_stats.IncrTableHit(table_id);
+        return true;
+    }
+
+    _ts_stats.IncrTableMiss(table_id);
+    return false;
+}
+
 /** \fn MPEGStreamData::IsRedundant(uint pid, const PSIPTable&) const
  *  \brief Returns true if table already seen.
  */
@@ -690,6 +756,14 @@ bool MPEGStreamData::IsRedundant(uint pid, const PSIPTable &psip) const
     const int table_id = psip.TableID();
     const int version  = psip.Version();
 
+    // a seeded table must be compared with the live one
+    if (TableID::PAT == table_id || TableID::PMT == table_id)
+    {
+        QMutexLocker locker(&_seeded_lock);
+        if (_seeded_crc.contains((table_id << 16) | psip.TableIDExtension()))
+            return false;
+    }
+
     if (TableID::PAT == table_id)
     {
         if (VersionPAT(psip.TableIDExtension()) != version)
@@ -722,6 +796,9 @@ bool MPEGStreamData::HandleTables(uint pid, const PSIPTable &psip)
     if (IsRedundant(pid, psip))
         return true;
 
+    if (IsSeededTable(psip))
+        return true;
+
     const int version = psip.Version();
     // If we get this far decode table
     switch (psip.TableID())
@@ -786,6 +863,115 @@ bool MPEGStreamData::HandleTables(uint pid, const PSIPTable &psip)
     return false;
 }
 
+/** \brief Processes a PAT or PMT section saved from an earlier tuning,
+ *         such as one from the PSICache, as if it had just been received.
+ *
+ *   This lets a channel change go ahead on the saved tables. When the
+ *   live section arrives it is checked by IsSeededTable() and processed
+ *   again only if it differs from the seeded one. In that case the live
+ *   tables replace the seeded ones in the PSICache entry for \a mplexid.
+ */
+void MPEGStreamData::SeedTable(uint mplexid, uint pid, const PSIPTable &psip)
+{
+    const uint key = (psip.TableID() << 16) | psip.TableIDExtension();
+    {
+        QMutexLocker locker(&_seeded_lock);
+        _seeded_crc.remove(key);
+    }
+
+    HandleTables(pid, psip);
+
+    QMutexLocker locker(&_seeded_lock);
+    _seeded_crc[key]  = psip.CRC();
+    _seeded_mplexid   = mplexid;
+    QByteArray data((const char*)psip.pesdata(), psip.SectionLength());
+    if (TableID::PAT == psip.TableID())
+    {
+        _seeded_pat = data;
+    }
+    else
+    {
+        _seeded_pmt     = data;
+        _seeded_program = psip.TableIDExtension();
+    }
+}
+
+/// \brief Returns true while a seeded table with this table_id has not
+///        been seen live yet.
+bool MPEGStreamData::HasSeededTable(uint table_id) const
+{
+    QMutexLocker locker(&_seeded_lock);
+    QMap<uint, uint>::const_iterator it = _seeded_crc.begin();
+    for (; it != _seeded_crc.end(); ++it)
+    {
+        if ((it.key() >> 16) == table_id)
+            return true;
+    }
+    return false;
+}
+
+/** \brief Returns true if psip is the live copy of a seeded table that
+ *         matches the seeded one, so it needs no further processing.
+ *
+ *   Once the live copies of all seeded tables have been seen, and any of
+ *   them differed, the live tables are saved in the PSICache.
+ */
+bool MPEGStreamData::IsSeededTable(const PSIPTable &psip)
+{
+    const uint table_id = psip.TableID();
+    if (TableID::PAT != table_id && TableID::PMT != table_id)
+        return false;
+
+    QMutexLocker locker(&_seeded_lock);
+
+    QMap<uint, uint>::iterator it =
+        _seeded_crc.find((table_id << 16) | psip.TableIDExtension());
+    if (it == _seeded_crc.end())
+        return false;
+
+    const uint crc = *it;
+    _seeded_crc.erase(it);
+
+    const QString name = (TableID::PAT == table_id) ? "PAT" : "PMT";
+    const bool same = (psip.CRC() == crc);
+    if (same)
+    {
+        LOG(VB_RECORD, LOG_INFO, QString("Live %1 0x%2 matches the seeded one")
+            .arg(name).arg(psip.TableIDExtension(), 0, 16));
+    }
+    else
+    {
+        LOG(VB_RECORD, LOG_WARNING,
+            QString("Live %1 0x%2 differs from the seeded one, using it")
+            .arg(name).arg(psip.TableIDExtension(), 0, 16));
+
+        QByteArray data((const char*)psip.pesdata(), psip.SectionLength());
+        if (TableID::PAT == table_id)
+            _seeded_pat = data;
+        else
+            _seeded_pmt = data;
+        _seeded_stale = true;
+    }
+
+    if (_seeded_stale && _seeded_crc.empty())
+    {
+        _seeded_stale = false;
+        QByteArray pat_data = _seeded_pat;
+        QByteArray pmt_data = _seeded_pmt;
+        uint mplexid = _seeded_mplexid;
+        uint program = _seeded_program;
+        locker.unlock();
+
+        const PSIPTable pat(PESPacket::ViewData(
+            reinterpret_cast<const unsigned char*>(pat_data.constData())));
+        const PSIPTable pmt(PESPacket::ViewData(
+            reinterpret_cast<const unsigned char*>(pmt_data.constData())));
+        PSICache::Store(mplexid, program, pat, pmt);
+    }
+
+    return same;
+}
+
 void MPEGStreamData::ProcessPAT(const ProgramAssociationTable *pat)
 {
     bool foundProgram = pat->FindPID(_desired_program);
@@ -1039,11 +1225,76 @@ int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
     return len - pos;
 }
 
+/** \fn MPEGStreamData::ProcessData(const vector<MPEGStreamData*>&,const unsigned char*,int)
+ *  \brief Demuxes a buffer once on behalf of several stream data objects.
+ *
+ *   This finds the packet boundaries just like the non-static ProcessData()
+ *   does, but only once for all of sdlist, and then hands each packet only
+ *   to the stream data objects interested in its PID. This keeps the cost
+ *   of several recordings from the same stream close to that of one.
+ *
+ *  \return number of unprocessed bytes at the end of buffer
+ */
+int MPEGStreamData::ProcessData(const vector<MPEGStreamData*> &sdlist,
+                                const unsigned char *buffer, int len)
+{
+    if (sdlist.size() == 1)
+        return sdlist[0]->ProcessData(buffer, len);
+
+    int pos = 0;
+    bool resync = false;
+
+    while (pos + int(TSPacket::kSize) <= len)
+    { // while we have a whole packet left...
+        if (buffer[pos] != SYNC_BYTE || resync)
+        {
+            int newpos = ResyncStream(buffer, pos+1, len);
+            LOG(VB_RECORD, LOG_DEBUG, QString("Resyncing @ %1+1 w/len %2 -> %3")
+                .arg(pos).arg(len).arg(newpos));
+            if (newpos == -1)
+                return len - pos;
+            if (newpos == -2)
+                return TSPacket::kSize;
+            pos = newpos;
+        }
+
+        const TSPacket *pkt = reinterpret_cast<const TSPacket*>(&buffer[pos]);
+        pos += TSPacket::kSize; // Advance to next TS packet
+        resync = false;
+
+        const uint pid = pkt->PID();
+        for (uint i = 0; i < sdlist.size(); i++)
+        {
+            if (sdlist[i]->IsInterestedInPID(pid))
+                sdlist[i]->ProcessTSPacket(*pkt);
+        }
+
+        // ProcessTSPacket() only fails on transport errors, so decide
+        // about resyncing from the packet itself, as each of sdlist would.
+        if (pkt->TransportError())
+        {
+            if (pos + int(TSPacket::kSize) > len)
+                continue;
+            if (buffer[pos] != SYNC_BYTE)
+            {
+                pos -= TSPacket::kSize;
+                resync = true;
+            }
+        }
+    }
+
+    return len - pos;
+}
+
 bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
 {
     bool ok = !tspacket.TransportError();
 
-    if (IsEncryptionTestPID(tspacket.PID()))
+    // PIDs are 13 bits, so this is always within the table
+    const uint flags = _pid_flags[tspacket.PID()];
+
+    if ((flags & kPIDFlagEncryptionTest) &&
+        IsEncryptionTestPID(tspacket.PID()))
     {
         ProcessEncryptedPacket(tspacket);
     }
@@ -1054,7 +1305,7 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
     if (tspacket.Scrambled())
         return true;
 
-    if (IsVideoPID(tspacket.PID()))
+    if (flags & kPIDFlagVideo)
     {
         for (uint j = 0; j < _ts_av_listeners.size(); j++)
             _ts_av_listeners[j]->ProcessVideoTSPacket(tspacket);
@@ -1062,7 +1313,7 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
         return true;
     }
 
-    if (IsAudioPID(tspacket.PID()))
+    if (flags & kPIDFlagAudio)
     {
         for (uint j = 0; j < _ts_av_listeners.size(); j++)
             _ts_av_listeners[j]->ProcessAudioTSPacket(tspacket);
@@ -1070,13 +1321,14 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
         return true;
     }
 
-    if (IsWritingPID(tspacket.PID()))
+    if (flags & kPIDFlagWriting)
     {
         for (uint j = 0; j < _ts_writing_listeners.size(); j++)
             _ts_writing_listeners[j]->ProcessTSPacket(tspacket);
     }
 
-    if (IsListeningPID(tspacket.PID()) && tspacket.HasPayload())
+    if (((flags & (kPIDFlagListening | kPIDFlagNotListening)) ==
+         kPIDFlagListening) && !_listening_disabled && tspacket.HasPayload())
     {
         HandleTSTables(&tspacket);
     }
@@ -1084,6 +1336,37 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
     return true;
 }
 
+/** \fn MPEGStreamData::RebuildPIDFlags(void)
+ *  \brief Recomputes the per PID role flags from the PID maps.
+ *
+ *   The Add and Remove PID methods keep the flags up to date, this
+ *   only needs to be called after one of the maps is changed directly.
+ */
+void MPEGStreamData::RebuildPIDFlags(void)
+{
+    memset(_pid_flags, 0, sizeof(_pid_flags));
+
+    pid_map_t::const_iterator it;
+    for (it = _pids_listening.begin(); it != _pids_listening.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagListening, true);
+    for (it = _pids_notlistening.begin(); it != _pids_notlistening.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagNotListening, true);
+    for (it = _pids_writing.begin(); it != _pids_writing.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagWriting, true);
+    for (it = _pids_audio.begin(); it != _pids_audio.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagAudio, true);
+
+    SetPIDFlag(_pid_video_single_program, kPIDFlagVideo, true);
+
+    QMutexLocker locker(&_encryption_lock);
+    QMap<uint, CryptInfo>::const_iterator eit;
+    for (eit = _encryption_pid_to_info.begin();
+         eit != _encryption_pid_to_info.end(); ++eit)
+    {
+        SetPIDFlag(eit.key(), kPIDFlagEncryptionTest, true);
+    }
+}
+
 int MPEGStreamData::ResyncStream(const unsigned char *buffer, int curr_pos,
                                  int len)
 {
@@ -1822,6 +2105,7 @@ void MPEGStreamData::AddEncryptionTestPID(uint pnum, uint pid, bool isvideo)
     AddListeningPID(pid);
 
     _encryption_pid_to_info[pid] = CryptInfo((isvideo) ? 10000 : 500, 8);
+    SetPIDFlag(pid, kPIDFlagEncryptionTest, true);
 
     _encryption_pid_to_pnums[pid].push_back(pnum);
     _encryption_pnum_to_pids[pnum].push_back(pid);
@@ -1865,6 +2149,7 @@ void MPEGStreamData::RemoveEncryptionTestPIDs(uint pnum)
             {
                 _encryption_pid_to_pnums.remove(pid);
                 _encryption_pid_to_info.remove(pid);
+                SetPIDFlag(pid, kPIDFlagEncryptionTest, false);
             }
         }
     }
@@ -1912,6 +2197,10 @@ void MPEGStreamData::ResetDecryptionMonitoringState(void)
 {
     QMutexLocker locker(&_encryption_lock);
 
+    QMap<uint, CryptInfo>::const_iterator it = _encryption_pid_to_info.begin();
+    for (; it != _encryption_pid_to_info.end(); ++it)
+        SetPIDFlag(it.key(), kPIDFlagEncryptionTest, false);
+
     _encryption_pid_to_info.clear();
     _encryption_pid_to_pnums.clear();
     _encryption_pnum_to_pids.clear();
@@ -16,6 +16,7 @@ using namespace std;
 #include "tspacket.h"
 #include "mythtimer.h"
 #include "streamlisteners.h"
+#include "tsstats.h"
 #include "eitscanner.h"
 #include "mythtvexp.h"
 
@@ -119,30 +120,46 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     // Table processing
     void SetIgnoreCRC(bool haveCRCbug) { _have_CRC_bug = haveCRCbug; }
     virtual bool IsRedundant(uint pid, const PSIPTable&) const;
+    const TSStats &GetTSStats(void) const { return _ts_stats; }
     virtual bool HandleTables(uint pid, const PSIPTable &psip);
+    void SeedTable(uint mplexid, uint pid, const PSIPTable &psip);
+    bool HasSeededTable(uint table_id) const;
     virtual void HandleTSTables(const TSPacket* tspacket);
     virtual bool ProcessTSPacket(const TSPacket& tspacket);
     virtual int  ProcessData(const unsigned char *buffer, int len);
+    static  int  ProcessData(const vector<MPEGStreamData*> &sdlist,
+                             const unsigned char *buffer, int len);
     inline  void HandleAdaptationFieldControl(const TSPacket* tspacket);
 
     // Listening
     virtual void AddListeningPID(
         uint pid, PIDPriority priority = kPIDPriorityNormal)
-        { _pids_listening[pid] = priority; }
+        { _pids_listening[pid] = priority;
+          SetPIDFlag(pid, kPIDFlagListening, true); }
     virtual void AddNotListeningPID(uint pid)
-        { _pids_notlistening[pid] = kPIDPriorityNormal; }
+        { _pids_notlistening[pid] = kPIDPriorityNormal;
+          SetPIDFlag(pid, kPIDFlagNotListening, true); }
     virtual void AddWritingPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { _pids_writing[pid] = priority; }
+        { _pids_writing[pid] = priority;
+          SetPIDFlag(pid, kPIDFlagWriting, true); }
     virtual void AddAudioPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { _pids_audio[pid] = priority; }
+        { _pids_audio[pid] = priority;
+          SetPIDFlag(pid, kPIDFlagAudio, true); }
 
-    virtual void RemoveListeningPID(uint pid) { _pids_listening.remove(pid);  }
+    virtual void RemoveListeningPID(uint pid)
+        { _pids_listening.remove(pid);
+          SetPIDFlag(pid, kPIDFlagListening, false); }
     virtual void RemoveNotListeningPID(uint pid)
-        { _pids_notlistening.remove(pid); }
-    virtual void RemoveWritingPID(uint pid) { _pids_writing.remove(pid);    }
-    virtual void RemoveAudioPID(uint pid)   { _pids_audio.remove(pid);      }
+        { _pids_notlistening.remove(pid);
+          SetPIDFlag(pid, kPIDFlagNotListening, false); }
+    virtual void RemoveWritingPID(uint pid)
+        { _pids_writing.remove(pid);
+          SetPIDFlag(pid, kPIDFlagWriting, false); }
+    virtual void RemoveAudioPID(uint pid)
+        { _pids_audio.remove(pid);
+          SetPIDFlag(pid, kPIDFlagAudio, false); }
 
     virtual bool IsListeningPID(uint pid) const;
     virtual bool IsNotListeningPID(uint pid) const;
@@ -150,6 +167,9 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     bool IsVideoPID(uint pid) const
         { return _pid_video_single_program == pid; }
     virtual bool IsAudioPID(uint pid) const;
+    /// \brief Returns true if ProcessTSPacket() may do anything with pid
+    bool IsInterestedInPID(uint pid) const
+        { return _pid_flags[pid & 0x1fff] & ~kPIDFlagNotListening; }
 
     const pid_map_t& ListeningPIDs(void) const
         { return _pids_listening; }
@@ -330,6 +350,8 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     // Table processing -- for internal use
     PSIPTable* AssemblePSIP(const TSPacket* tspacket, bool& moreTablePackets);
     bool AssemblePSIP(PSIPTable& psip, TSPacket* tspacket);
+    bool IsRedundantSectionStart(const TSPacket *tspacket, int offset);
+    bool IsSeededTable(const PSIPTable &psip);
     void SavePartialPSIP(uint pid, PSIPTable* packet);
     PSIPTable* GetPartialPSIP(uint pid)
         { return _partial_psip_packet_cache[pid]; }
@@ -356,6 +378,7 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     QString                   _sistandard;
 
     bool                      _have_CRC_bug;
+    TSStats                   _ts_stats;
 
     mutable QMutex            _si_time_lock;
     uint                      _si_time_offset_cnt;
@@ -373,6 +396,29 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     pid_map_t                 _pids_audio;
     bool                      _listening_disabled;
 
+    /// Per PID role flags mirroring the PID maps above, so that
+    /// ProcessTSPacket() can classify a packet with a single lookup.
+    enum
+    {
+        kPIDFlagListening      = 0x01,
+        kPIDFlagNotListening   = 0x02,
+        kPIDFlagWriting        = 0x04,
+        kPIDFlagAudio          = 0x08,
+        kPIDFlagVideo          = 0x10,
+        kPIDFlagEncryptionTest = 0x20,
+    };
+    void SetPIDFlag(uint pid, uint flag, bool on)
+    {
+        if (pid > 0x1fff)
+            return;
+        if (on)
+            _pid_flags[pid] |= flag;
+        else
+            _pid_flags[pid] &= ~flag;
+    }
+    void RebuildPIDFlags(void);
+    unsigned char             _pid_flags[0x2000];
+
     // Encryption monitoring
     mutable QMutex            _encryption_lock;
     QMap<uint, CryptInfo>     _encryption_pid_to_info;
@@ -396,6 +442,17 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     sections_map_t            _cat_section_seen;
     sections_map_t            _pmt_section_seen;
 
+    // Seeded tables, protected by _seeded_lock
+    mutable QMutex            _seeded_lock;
+    /// CRCs of the PAT and PMT sections passed to SeedTable() that have
+    /// not been seen live yet, keyed by table_id << 16 | table_id_extension
+    QMap<uint, uint>          _seeded_crc;
+    uint                      _seeded_mplexid;
+    uint                      _seeded_program;
+    QByteArray                _seeded_pat;   ///< latest PAT section
+    QByteArray                _seeded_pmt;   ///< latest PMT section
+    bool                      _seeded_stale; ///< a live table differed
+
     // PSIP construction
     pid_psip_map_t            _partial_psip_packet_cache;
 
@@ -364,6 +364,10 @@ class MTV_PUBLIC PSIPTable : public PESPacket
     PSIPTable(const PESPacket& pkt, bool)
         : PESPacket(reinterpret_cast<const TSPacket*>(pkt.tsheader()), false)
         { ; }
+    // creates non-clone version without a CRC check, for ViewHeader
+    PSIPTable(const TSPacket& tspacket, bool, bool)
+        : PESPacket(&tspacket, false, false)
+        { ; }
   public:
     PSIPTable(const PSIPTable& table) : PESPacket(table)
     {
@@ -388,6 +392,11 @@ class MTV_PUBLIC PSIPTable : public PESPacket
     static PSIPTable View(TSPacket& tspacket)
         { return PSIPTable(PESPacket::View(tspacket), false); }
 
+    /// Returns a view of the section starting in tspacket without
+    /// checking its CRC, only the header fields may be used.
+    static const PSIPTable ViewHeader(const TSPacket& tspacket)
+        { return PSIPTable(tspacket, false, false); }
+
     // Section            Bits   Start Byte sbit
     // -----------------------------------------
     // table_id             8       0.0       0
@@ -13,7 +13,10 @@ extern "C" {
 }
 
 #include <vector>
-#include <map>
+
+#include <QThreadStorage>
+#include <QAtomicInt>
+#include <QMutex>
 
 using namespace std;
 
@@ -211,141 +214,309 @@ float SequenceHeader::aspect(bool mpeg1) const
 /////////////////////////////////////////////////////////////////////////
 // Memory allocator to avoid malloc global lock and waste less memory. //
 /////////////////////////////////////////////////////////////////////////
-
-static vector<unsigned char*> mem188;
-static vector<unsigned char*> free188;
-static map<unsigned char*, bool> alloc188;
-
-static vector<unsigned char*> mem4096;
-static vector<unsigned char*> free4096;
-static map<unsigned char*, bool> alloc4096;
-
-#define BLOCKS188 512
-static unsigned char* get_188_block()
+//
+// Every thread gets its own cache of free buffers for each size class,
+// so the recorder and signal monitor threads never contend with each
+// other. Each buffer is preceded by a small header naming its size class
+// and the cache that allocated it, so pes_free() does not have to search
+// for the owner. Buffers freed on another thread are handed back to the
+// owning cache under a per cache lock, and picked up by the owner the
+// next time its own free list for that size runs dry.
+
+class PESAllocCache;
+
+union PESBlockHeader
 {
-    if (free188.empty())
+    struct
     {
-        mem188.push_back((unsigned char*) malloc(188 * BLOCKS188));
-        free188.reserve(BLOCKS188);
-        unsigned char* block_start = mem188.back();
-        for (uint i = 0; i < BLOCKS188; ++i)
-            free188.push_back(i*188 + block_start);
-    }
-
-    unsigned char *ptr = free188.back();
-    free188.pop_back();
-    alloc188[ptr] = true;
-    return ptr;
-}
-#undef BLOCKS188
+        PESAllocCache *owner;
+        uint32_t       size_class;
+        uint32_t       magic;
+    } h;
+    uint64_t align[2]; // keep the buffer 16 byte aligned
+};
 
-static bool is_188_block(unsigned char* ptr)
+#define PES_SIZE_CLASSES 6
+static const uint kPESClassSize[PES_SIZE_CLASSES] =
+    { 188, 4096, 8192, 16384, 32768, 65536 };
+/// Free buffers kept per thread for each size class, the rest are freed
+static const uint kPESClassKeep[PES_SIZE_CLASSES] =
+    { 1024, 256, 64, 32, 16, 16 };
+static const uint32_t kPESNoClass    = 0xffffffff; ///< plain malloc
+static const uint32_t kPESBlockMagic = 0x50455362;
+/// Log the allocation counters every this many allocations
+static const uint64_t kPESStatsInterval = 1 << 20;
+
+/// Free buffers are kept on singly linked lists threaded through
+/// the start of the (unused) buffer.
+static inline PESBlockHeader *&pes_next(PESBlockHeader *hdr)
 {
-    return alloc188.find(ptr) != alloc188.end();
+    return *reinterpret_cast<PESBlockHeader**>(hdr + 1);
 }
 
-static void return_188_block(unsigned char* ptr)
+static inline uint pes_size_class(uint size)
 {
-    alloc188.erase(ptr);
-    free188.push_back(ptr);
-    // free the allocator only if more than 1 block was used
-    if (alloc188.empty() && mem188.size() > 1)
+    for (uint i = 0; i < PES_SIZE_CLASSES; i++)
     {
-        vector<unsigned char*>::iterator it;
-        for (it = mem188.begin(); it != mem188.end(); ++it)
-            free(*it);
-        mem188.clear();
-        free188.clear();
-#if 0
-        LOG(VB_GENERAL, LOG_DEBUG, "freeing all 188 blocks");
-#endif
+        if (size <= kPESClassSize[i])
+            return i;
     }
+    return kPESNoClass;
 }
 
-#define BLOCKS4096 128
-static unsigned char* get_4096_block()
+class PESAllocCache
 {
-    if (free4096.empty())
+  public:
+    PESAllocCache() :
+        m_refs(1), m_remotePending(false), m_detached(false),
+        m_allocs(0), m_reused(0), m_mallocs(0), m_large(0),
+        m_frees(0), m_remoteFrees(0)
     {
-        mem4096.push_back((unsigned char*) malloc(4096 * BLOCKS4096));
-        free4096.reserve(BLOCKS4096);
-        unsigned char* block_start = mem4096.back();
-        for (uint i = 0; i < BLOCKS4096; ++i)
-            free4096.push_back(i*4096 + block_start);
+        for (uint i = 0; i < PES_SIZE_CLASSES; i++)
+        {
+            m_free[i]       = NULL;
+            m_freeCount[i]  = 0;
+            m_remote[i]     = NULL;
+        }
     }
 
-    unsigned char *ptr = free4096.back();
-    free4096.pop_back();
-    alloc4096[ptr] = true;
-    return ptr;
-}
-#undef BLOCKS4096
+    unsigned char *Alloc(uint size)
+    {
+        m_allocs++;
+        if ((m_allocs % kPESStatsInterval) == 0)
+            LogStats();
 
-static bool is_4096_block(unsigned char* ptr)
-{
-    return alloc4096.find(ptr) != alloc4096.end();
-}
+        uint cls = pes_size_class(size);
+        PESBlockHeader *hdr;
+        if (kPESNoClass == cls)
+        {
+            m_large++;
+            hdr = (PESBlockHeader*) malloc(sizeof(PESBlockHeader) + size);
+            hdr->h.owner = NULL;
+        }
+        else
+        {
+            if (!m_free[cls] && m_remotePending)
+                DrainRemote();
 
-static void return_4096_block(unsigned char* ptr)
-{
-    alloc4096.erase(ptr);
-    free4096.push_back(ptr);
-
-#if 0 // enable this to debug memory leaks
-        LOG(VB_GENERAL, LOG_DEBUG, QString("%1 4096 blocks remain")
-            .arg(alloc4096.size()));
-        map<unsigned char*, bool>::iterator it;
-        for (it = alloc4096.begin(); it != alloc4096.end(); ++it)
+            if (m_free[cls])
+            {
+                m_reused++;
+                hdr = m_free[cls];
+                m_free[cls] = pes_next(hdr);
+                m_freeCount[cls]--;
+            }
+            else
+            {
+                m_mallocs++;
+                hdr = (PESBlockHeader*) malloc(
+                    sizeof(PESBlockHeader) + kPESClassSize[cls]);
+            }
+            hdr->h.owner = this;
+            m_refs.ref();
+        }
+
+        hdr->h.size_class = cls;
+        hdr->h.magic      = kPESBlockMagic;
+        return reinterpret_cast<unsigned char*>(hdr + 1);
+    }
+
+    /// Returns a buffer allocated by this cache, on the owning thread.
+    void Free(PESBlockHeader *hdr)
+    {
+        m_frees++;
+        PushFree(hdr);
+        m_refs.deref(); // the thread holds a reference, never the last
+    }
+
+    /// Returns a buffer allocated by this cache, from another thread.
+    void RemoteFree(PESBlockHeader *hdr)
+    {
         {
-            TSPacket *ts = (TSPacket*) it->first;
-            LGO(VB_GENERAL, LOG_DEBUG, QString("PES Packet: pid(0x%1)")
-                .arg(ts->PID(),0,16));
-            if (ts->PID() == 0x1ffb)
+            QMutexLocker locker(&m_remoteLock);
+            if (m_detached)
+            {
+                free(hdr);
+            }
+            else
             {
-                LOG(VB_GENERAL, LOG_DEBUG, QString(" tid(0x%1) ext(0x%2)")
-                    .arg(PSIPTable::View(*ts).TableID(),0,16)
-                    .arg(PSIPTable::View(*ts).TableIDExtension(),0,16));
+                uint cls = hdr->h.size_class;
+                pes_next(hdr) = m_remote[cls];
+                m_remote[cls] = hdr;
+                m_remotePending = true;
             }
         }
-#endif
+        Deref();
+    }
 
-    // free the allocator only if more than 1 block was used
-    if (alloc4096.empty() && mem4096.size() > 1)
+    /// Called when the owning thread exits, buffers still in use
+    /// elsewhere keep the cache alive until they are freed.
+    void Detach(void)
     {
-        vector<unsigned char*>::iterator it;
-        for (it = mem4096.begin(); it != mem4096.end(); ++it)
-            free(*it);
-        mem4096.clear();
-        free4096.clear();
-#if 0
-        LOG(VB_GENERAL, LOG_DEBUG, "freeing all 4096 blocks");
-#endif
+        LogStats();
+        for (uint i = 0; i < PES_SIZE_CLASSES; i++)
+            FreeList(m_free[i]);
+
+        {
+            QMutexLocker locker(&m_remoteLock);
+            m_detached = true;
+            for (uint i = 0; i < PES_SIZE_CLASSES; i++)
+                FreeList(m_remote[i]);
+        }
+        Deref();
     }
-}
 
-static QMutex pes_alloc_mutex;
+    void CountFree(void)   { m_frees++; }
+    void CountRemoteFree(void) { m_frees++; m_remoteFrees++; }
+
+  private:
+    ~PESAllocCache() { }
+
+    void Deref(void)
+    {
+        if (!m_refs.deref())
+            delete this;
+    }
+
+    void PushFree(PESBlockHeader *hdr)
+    {
+        uint cls = hdr->h.size_class;
+        if (m_freeCount[cls] >= kPESClassKeep[cls])
+        {
+            free(hdr);
+            return;
+        }
+        pes_next(hdr) = m_free[cls];
+        m_free[cls] = hdr;
+        m_freeCount[cls]++;
+    }
+
+    void DrainRemote(void)
+    {
+        PESBlockHeader *remote[PES_SIZE_CLASSES];
+        {
+            QMutexLocker locker(&m_remoteLock);
+            for (uint i = 0; i < PES_SIZE_CLASSES; i++)
+            {
+                remote[i] = m_remote[i];
+                m_remote[i] = NULL;
+            }
+            m_remotePending = false;
+        }
+
+        for (uint i = 0; i < PES_SIZE_CLASSES; i++)
+        {
+            while (remote[i])
+            {
+                PESBlockHeader *next = pes_next(remote[i]);
+                PushFree(remote[i]);
+                remote[i] = next;
+            }
+        }
+    }
+
+    static void FreeList(PESBlockHeader *&list)
+    {
+        while (list)
+        {
+            PESBlockHeader *next = pes_next(list);
+            free(list);
+            list = next;
+        }
+    }
+
+    void LogStats(void) const
+    {
+        if (!m_allocs)
+            return;
+        LOG(VB_RECORD, LOG_DEBUG,
+            QString("PES allocator: %1 allocs (%2 reused, %3 new, %4 large), "
+                    "%5 frees (%6 from other threads)")
+            .arg(m_allocs).arg(m_reused).arg(m_mallocs).arg(m_large)
+            .arg(m_frees).arg(m_remoteFrees));
+    }
+
+  private:
+    /// One reference for the owning thread plus one per buffer in use
+    QAtomicInt      m_refs;
+
+    PESBlockHeader *m_free[PES_SIZE_CLASSES];
+    uint            m_freeCount[PES_SIZE_CLASSES];
+
+    QMutex          m_remoteLock;
+    PESBlockHeader *m_remote[PES_SIZE_CLASSES]; ///< protected by m_remoteLock
+    volatile bool   m_remotePending;
+    bool            m_detached;                 ///< protected by m_remoteLock
+
+    // counters, only touched by the owning thread
+    uint64_t        m_allocs;
+    uint64_t        m_reused;
+    uint64_t        m_mallocs;
+    uint64_t        m_large;
+    uint64_t        m_frees;
+    uint64_t        m_remoteFrees;
+};
+
+/// Detaches the thread's cache when QThreadStorage deletes it on exit
+class PESAllocThread
+{
+  public:
+    PESAllocThread() : m_cache(new PESAllocCache()) { }
+    ~PESAllocThread() { m_cache->Detach(); }
+    PESAllocCache *m_cache;
+};
+
+static QThreadStorage<PESAllocThread*> pes_alloc_thread;
+
+static inline PESAllocCache *pes_alloc_cache(void)
+{
+    if (!pes_alloc_thread.hasLocalData())
+        pes_alloc_thread.setLocalData(new PESAllocThread());
+    return pes_alloc_thread.localData()->m_cache;
+}
 
 unsigned char *pes_alloc(uint size)
 {
-    QMutexLocker locker(&pes_alloc_mutex);
 #ifndef USING_VALGRIND
-    if (size <= 188)
-        return get_188_block();
-    else if (size <= 4096)
-        return get_4096_block();
-#endif // USING_VALGRIND
+    return pes_alloc_cache()->Alloc(size);
+#else
     return (unsigned char*) malloc(size);
+#endif // USING_VALGRIND
 }
 
 void pes_free(unsigned char *ptr)
 {
-    QMutexLocker locker(&pes_alloc_mutex);
 #ifndef USING_VALGRIND
-    if (is_188_block(ptr))
-        return_188_block(ptr);
-    else if (is_4096_block(ptr))
-        return_4096_block(ptr);
+    if (!ptr)
+        return;
+
+    PESBlockHeader *hdr = reinterpret_cast<PESBlockHeader*>(ptr) - 1;
+    if (hdr->h.magic != kPESBlockMagic)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "pes_free: buffer was not allocated by pes_alloc");
+        return;
+    }
+
+    PESAllocCache *cache = pes_alloc_cache();
+    if (kPESNoClass == hdr->h.size_class)
+    {
+        cache->CountFree();
+        hdr->h.magic = 0;
+        free(hdr);
+    }
+    else if (hdr->h.owner == cache)
+    {
+        hdr->h.magic = 0;
+        cache->Free(hdr);
+    }
     else
+    {
+        cache->CountRemoteFree();
+        hdr->h.magic = 0;
+        hdr->h.owner->RemoteFree(hdr);
+    }
+#else
+    free(ptr);
 #endif // USING_VALGRIND
-        free(ptr);
 }
@@ -25,7 +25,7 @@ void pes_free(unsigned char *ptr);
 class PESPacket
 {
     /// Only handles single TS packet PES packets, for PMT/PAT tables basically
-    void InitPESPacket(TSPacket& tspacket)
+    void InitPESPacket(TSPacket& tspacket, bool verify_crc = true)
     {
         if (tspacket.PayloadStart())
             _psiOffset = tspacket.AFCOffset() + tspacket.StartOfFieldPointer();
@@ -39,7 +39,8 @@ class PESPacket
         _badPacket = true;
         // first check if Length() will return something useful and
         // than check if the packet ends in the first TSPacket
-        if ((_pesdata - tspacket.data()) <= (188-3) &&
+        if (verify_crc &&
+            (_pesdata - tspacket.data()) <= (188-3) &&
             (_pesdata + Length() - tspacket.data()) <= (188-3))
         {
             _badPacket = !VerifyCRC();
@@ -56,6 +57,16 @@ class PESPacket
         _fullbuffer = const_cast<unsigned char*>(tspacket->data());
         _pesdataSize = TSPacket::kSize - (_pesdata - _fullbuffer);
     }
+    // does not create it's own data, and does not check the CRC
+    // so only the header fields may be used
+    PESPacket(const TSPacket* tspacket, bool, bool verify_crc)
+        : _pesdata(NULL),    _fullbuffer(NULL),
+          _ccLast(tspacket->ContinuityCounter()), _allocSize(0)
+    {
+        InitPESPacket(const_cast<TSPacket&>(*tspacket), verify_crc);
+        _fullbuffer = const_cast<unsigned char*>(tspacket->data());
+        _pesdataSize = TSPacket::kSize - (_pesdata - _fullbuffer);
+    }
     // does not create it's own data
     PESPacket(const unsigned char *pesdata, bool)
         : _pesdata(const_cast<unsigned char*>(pesdata)),
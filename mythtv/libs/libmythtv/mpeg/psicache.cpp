@@ -0,0 +1,171 @@
+// -*- Mode: c++ -*-
+
+// Qt headers
+#include <QDataStream>
+#include <QFile>
+
+// MythTV headers
+#include "psicache.h"
+#include "mpegtables.h"
+#include "mythlogging.h"
+#include "mythdirs.h"
+
+#define LOC QString("PSICache: ")
+
+static const quint32 kPSICacheMagic   = 0x50534943; // "PSIC"
+static const quint32 kPSICacheVersion = 1;
+
+QMutex             PSICache::s_lock;
+bool               PSICache::s_loaded = false;
+PSICache::EntryMap PSICache::s_cache;
+
+static inline quint64 psi_cache_key(uint mplexid, uint program_num)
+{
+    return (((quint64)mplexid) << 16) | (program_num & 0xffff);
+}
+
+/// Returns true if data holds exactly one whole section of the table.
+static bool is_whole_section(const QByteArray &data, uint table_id)
+{
+    if (data.size() < 3 || (uchar)data[0] != table_id)
+        return false;
+    uint len = (((uchar)data[1] & 0x0f) << 8) | (uchar)data[2];
+    return (int)len + 3 == data.size();
+}
+
+QString PSICache::GetFilename(void)
+{
+    return GetConfDir() + "/psicache";
+}
+
+/** \brief Returns the last PAT and PMT sections seen for the program.
+ *
+ *  \return false if there is no cached PAT and PMT for it.
+ */
+bool PSICache::Lookup(uint mplexid, uint program_num,
+                      QByteArray &pat, QByteArray &pmt)
+{
+    if (!mplexid)
+        return false;
+
+    QMutexLocker locker(&s_lock);
+    Load();
+
+    EntryMap::const_iterator it =
+        s_cache.find(psi_cache_key(mplexid, program_num));
+    if (it == s_cache.end())
+        return false;
+
+    if (!is_whole_section((*it).first,  TableID::PAT) ||
+        !is_whole_section((*it).second, TableID::PMT))
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Ignoring corrupt entry for program %1 on multiplex %2")
+            .arg(program_num).arg(mplexid));
+        return false;
+    }
+
+    pat = (*it).first;
+    pmt = (*it).second;
+    return true;
+}
+
+/// \brief Remembers the program's PAT and PMT, saving the cache if changed.
+void PSICache::Store(uint mplexid, uint program_num,
+                     const PSIPTable &pat, const PSIPTable &pmt)
+{
+    if (!mplexid)
+        return;
+
+    Entry entry(
+        QByteArray((const char*)pat.pesdata(), pat.SectionLength()),
+        QByteArray((const char*)pmt.pesdata(), pmt.SectionLength()));
+
+    QMutexLocker locker(&s_lock);
+    Load();
+
+    quint64 key = psi_cache_key(mplexid, program_num);
+    EntryMap::const_iterator it = s_cache.find(key);
+    if (it != s_cache.end() && *it == entry)
+        return;
+
+    s_cache[key] = entry;
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC +
+        QString("Cached PAT and PMT for program %1 on multiplex %2")
+        .arg(program_num).arg(mplexid));
+
+    Save();
+}
+
+void PSICache::Load(void)
+{
+    if (s_loaded)
+        return;
+    s_loaded = true;
+
+    QFile file(GetFilename());
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != kPSICacheMagic || version != kPSICacheVersion)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Ignoring %1, unknown format").arg(file.fileName()));
+        return;
+    }
+
+    EntryMap cache;
+    in >> cache;
+    if (in.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Ignoring %1, it is truncated").arg(file.fileName()));
+        return;
+    }
+
+    s_cache = cache;
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC + QString("Loaded %1 programs from %2")
+        .arg(s_cache.size()).arg(file.fileName()));
+}
+
+void PSICache::Save(void)
+{
+    QString filename = GetFilename();
+    QFile file(filename + ".tmp");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to open %1: %2")
+            .arg(file.fileName()).arg(file.errorString()));
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << kPSICacheMagic << kPSICacheVersion << s_cache;
+
+    if (out.status() != QDataStream::Ok || !file.flush())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to write %1: %2")
+            .arg(file.fileName()).arg(file.errorString()));
+        file.close();
+        file.remove();
+        return;
+    }
+    file.close();
+
+    // QFile::rename() does not replace an existing file
+    QFile::remove(filename);
+    if (!file.rename(filename))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to rename %1 to %2")
+            .arg(file.fileName()).arg(filename));
+        file.remove();
+    }
+}
@@ -0,0 +1,47 @@
+// -*- Mode: c++ -*-
+#ifndef _PSI_CACHE_H_
+#define _PSI_CACHE_H_
+
+// Qt headers
+#include <QByteArray>
+#include <QMutex>
+#include <QPair>
+#include <QMap>
+
+// MythTV headers
+#include "mythtvexp.h"
+
+class PSIPTable;
+
+/** \class PSICache
+ *  \brief Remembers the last PAT and PMT seen for each program on each
+ *         multiplex, so a channel change can seed MPEGStreamData with
+ *         them instead of waiting for the tables to be broadcast again.
+ *
+ *   The raw sections are kept in memory and saved to "psicache" in the
+ *   configuration directory, so the cache survives a backend restart.
+ *   Seeded tables are only a head start, MPEGStreamData compares them
+ *   with the live tables once those arrive.
+ */
+class MTV_PUBLIC PSICache
+{
+  public:
+    static bool Lookup(uint mplexid, uint program_num,
+                       QByteArray &pat, QByteArray &pmt);
+    static void Store(uint mplexid, uint program_num,
+                      const PSIPTable &pat, const PSIPTable &pmt);
+
+  private:
+    typedef QPair<QByteArray, QByteArray> Entry; ///< PAT, PMT sections
+    typedef QMap<quint64, Entry>          EntryMap;
+
+    static QString GetFilename(void);
+    static void Load(void);
+    static void Save(void);
+
+    static QMutex   s_lock;
+    static bool     s_loaded; ///< protected by s_lock
+    static EntryMap s_cache;  ///< protected by s_lock
+};
+
+#endif // _PSI_CACHE_H_
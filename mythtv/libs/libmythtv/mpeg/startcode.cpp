@@ -0,0 +1,120 @@
+// -*- Mode: c++ -*-
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "startcode.h"
+
+static inline uint32_t read_be32(const uint8_t *p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+           (uint32_t(p[2]) << 8)  |  uint32_t(p[3]);
+}
+
+/// Consumes up to three bytes through *state, this catches start codes
+/// that began in the previous buffer. Returns NULL if the search should
+/// continue at p + 3.
+static inline const uint8_t *start_code_prologue(
+    const uint8_t *&p, const uint8_t *end, uint32_t *state)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t tmp = *state << 8;
+        *state = tmp + *(p++);
+        if (tmp == 0x100 || p == end)
+            return p;
+    }
+    return NULL;
+}
+
+/// Index of the first 00 00 01 whose 01 is at or after q, checking only
+/// 01 positions before last. q[-2] must be readable. Returns last if none.
+static inline const uint8_t *scan_c(const uint8_t *q, const uint8_t *last)
+{
+    // Like FFmpeg, skip ahead by up to three bytes at a time
+    while (q < last)
+    {
+        if (q[0] > 1)
+            q += 3;
+        else if (q[-1])
+            q += 2;
+        else if (q[-2] | (q[0] - 1))
+            q++;
+        else
+            return q;
+    }
+    return last;
+}
+
+#if defined(__SSE2__)
+static inline const uint8_t *scan_sse2(const uint8_t *q, const uint8_t *last)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi8(1);
+
+    while (q + 16 <= last)
+    {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(q));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(q - 1));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(q - 2));
+        __m128i m  = _mm_and_si128(
+            _mm_cmpeq_epi8(v0, one),
+            _mm_cmpeq_epi8(_mm_or_si128(v1, v2), zero));
+        int mask = _mm_movemask_epi8(m);
+        if (mask)
+            return q + __builtin_ctz(mask);
+        q += 16;
+    }
+
+    return scan_c(q, last);
+}
+#endif
+
+static inline const uint8_t *finish(
+    const uint8_t *q, const uint8_t *last, const uint8_t *end,
+    uint32_t *state)
+{
+    if (q < last)
+    {
+        // q points at the 01, return the byte after the start code
+        *state = read_be32(q - 2);
+        return q + 2;
+    }
+    *state = read_be32(end - 4);
+    return end;
+}
+
+const uint8_t *find_start_code_c(
+    const uint8_t *p, const uint8_t *end, uint32_t *state)
+{
+    if (p >= end)
+        return end;
+
+    const uint8_t *ret = start_code_prologue(p, end, state);
+    if (ret)
+        return ret;
+
+    // The 01 of the next start code is at p - 1 or later, and it must
+    // be followed by the start code value byte.
+    const uint8_t *last = end - 1;
+    return finish(scan_c(p - 1, last), last, end, state);
+}
+
+const uint8_t *find_start_code(
+    const uint8_t *p, const uint8_t *end, uint32_t *state)
+{
+#if defined(__SSE2__)
+    if (p >= end)
+        return end;
+
+    const uint8_t *ret = start_code_prologue(p, end, state);
+    if (ret)
+        return ret;
+
+    const uint8_t *last = end - 1;
+    return finish(scan_sse2(p - 1, last), last, end, state);
+#else
+    return find_start_code_c(p, end, state);
+#endif
+}
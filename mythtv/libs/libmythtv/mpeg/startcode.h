@@ -0,0 +1,25 @@
+#ifndef _START_CODE_H_
+#define _START_CODE_H_
+
+#include <stdint.h>
+
+#include "mythtvexp.h"
+
+/** \brief Finds the next MPEG start code (00 00 01 xx) in [p, end).
+ *
+ *   This is a drop in replacement for FFmpeg's avpriv_mpv_find_start_code().
+ *   *state carries the last four bytes seen across calls so start codes
+ *   split between buffers are found. When a start code is found the
+ *   pointer to the byte following it is returned and *state holds the
+ *   start code, otherwise end is returned.
+ *
+ *   On x86 with SSE2 the search is done sixteen bytes at a time.
+ */
+MTV_PUBLIC const uint8_t *find_start_code(
+    const uint8_t *p, const uint8_t *end, uint32_t *state);
+
+/// \brief Plain C version of find_start_code(), for comparison.
+MTV_PUBLIC const uint8_t *find_start_code_c(
+    const uint8_t *p, const uint8_t *end, uint32_t *state);
+
+#endif // _START_CODE_H_
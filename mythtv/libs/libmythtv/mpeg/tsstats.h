@@ -3,35 +3,67 @@
 #ifndef __TS_STATS__
 #define __TS_STATS__
 
+#include <string.h>
+
 #include <QString>
 #include <QMap>
 
 /** \class TSStats
- *  \brief Collects statistics on the number of TSPacket's seen on each PID.
+ *  \brief Collects statistics on the number of TSPacket's seen on each PID,
+ *         and on how many PSIP sections of each table_id were recognized
+ *         as already seen before being assembled (hits) or had to be
+ *         assembled and parsed (misses).
  *
- *  \sa TSPacket, HDTVRecorder
+ *  \sa TSPacket, MPEGStreamData
  */
 class TSStats
 {
   public:
-    TSStats() : _tspacket_count(0) { ; }
+    TSStats() : _tspacket_count(0) { ResetTableCounts(); }
     void IncrPIDCount(int pid)  { _pid_counts[pid]++;  }
     void IncrTSPacketCount() { _tspacket_count++; }
-    long long TSPacketCount() { return _tspacket_count; }
-    void Reset() { _tspacket_count = 0; _pid_counts.clear(); }
-    inline QString toString();
+    void IncrTableHit(uint table_id)  { _table_hits[table_id & 0xff]++;   }
+    void IncrTableMiss(uint table_id) { _table_misses[table_id & 0xff]++; }
+    long long TSPacketCount() const { return _tspacket_count; }
+    long long TableHits(uint table_id) const
+        { return _table_hits[table_id & 0xff]; }
+    long long TableMisses(uint table_id) const
+        { return _table_misses[table_id & 0xff]; }
+    void Reset()
+    {
+        _tspacket_count = 0;
+        _pid_counts.clear();
+        ResetTableCounts();
+    }
+    inline QString toString() const;
   private:
+    void ResetTableCounts()
+    {
+        memset(_table_hits,   0, sizeof(_table_hits));
+        memset(_table_misses, 0, sizeof(_table_misses));
+    }
+
     long long _tspacket_count;
     QMap<int, long long> _pid_counts;
+    long long _table_hits[256];
+    long long _table_misses[256];
 };
 
-inline QString TSStats::toString() {
+inline QString TSStats::toString() const {
     QString str("Transport Stream Statistics\n");
-    str.append(QString("TSPacket Count: %1").arg((long)_tspacket_count));
-    QMapIterator<int, long long> it = _pid_counts.begin();
-    for (; it != _pid_counts.end(); it++)
+    str.append(QString("TSPacket Count: %1").arg(_tspacket_count));
+    QMap<int, long long>::const_iterator it = _pid_counts.begin();
+    for (; it != _pid_counts.end(); ++it)
         str.append(QString("\nPID 0x%1 Count: %2").
-                   arg((int)it.key(),0,16).arg((long)it.data(),10,10));
+                   arg((int)it.key(),0,16).arg(*it,10,10));
+    for (uint i = 0; i < 256; i++)
+    {
+        if (!_table_hits[i] && !_table_misses[i])
+            continue;
+        str.append(QString("\nTable 0x%1 Hits: %2 Misses: %3")
+                   .arg(i,2,16,QChar('0'))
+                   .arg(_table_hits[i]).arg(_table_misses[i]));
+    }
     return str;
 }
 
@@ -33,6 +33,7 @@ extern "C" {
 #include "mpegrecorder.h"
 #include "ringbuffer.h"
 #include "mythcorecontext.h"
+#include "positionmapwriter.h"
 #include "programinfo.h"
 #include "recordingprofile.h"
 #include "tv_rec.h"
@@ -1176,6 +1177,8 @@ void MpegRecorder::Reset(void)
 
     if (curRecording)
     {
+        // don't let queued deltas from before the reset land after it
+        PositionMapWriter::Flush();
         curRecording->ClearPositionMap(MARK_GOP_BYFRAME);
     }
     if (_stream_data)
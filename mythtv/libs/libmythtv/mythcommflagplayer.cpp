@@ -4,6 +4,9 @@ using namespace std;
 #include <QRunnable>
 
 #include "mythcommflagplayer.h"
+#include "playercontext.h"
+#include "programinfo.h"
+#include "ringbuffer.h"
 #include "mthreadpool.h"
 #include "mythlogging.h"
 
@@ -218,3 +221,44 @@ bool MythCommFlagPlayer::RebuildSeekTable(
 
     return true;
 }
+
+/** \brief Creates another flagging player for the same recording, so a
+ *         part of it can be flagged at the same time as this one.
+ *
+ *   The new player belongs to the calling thread and is deleted along
+ *   with the returned PlayerContext.
+ *
+ *  \return NULL if the recording could not be opened again.
+ */
+PlayerContext *MythCommFlagPlayer::CreateSegmentPlayer(void)
+{
+    if (!player_ctx || !player_ctx->buffer)
+        return NULL;
+
+    QString filename = player_ctx->buffer->GetFilename();
+    RingBuffer *rbuf = RingBuffer::Create(filename, false);
+    if (!rbuf)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Unable to create RingBuffer for %1").arg(filename));
+        return NULL;
+    }
+
+    PlayerContext *ctx = new PlayerContext(kFlaggerInUseID);
+    player_ctx->LockPlayingInfo(__FILE__, __LINE__);
+    ctx->SetPlayingInfo(player_ctx->playingInfo);
+    player_ctx->UnlockPlayingInfo(__FILE__, __LINE__);
+    ctx->SetRingBuffer(rbuf);
+
+    MythCommFlagPlayer *cfp = new MythCommFlagPlayer(playerFlags);
+    ctx->SetPlayer(cfp);
+    cfp->SetPlayerInfo(NULL, NULL, ctx);
+
+    return ctx;
+}
+
+/// Returns the last keyframe at or before frame, or -1 if it isn't known.
+long long MythCommFlagPlayer::GetKeyframeBefore(long long frame)
+{
+    return decoder ? decoder->GetKeyframeBefore(frame) : -1;
+}
@@ -3,12 +3,17 @@
 
 #include "mythplayer.h"
 
+class PlayerContext;
+
 class MTV_PUBLIC MythCommFlagPlayer : public MythPlayer
 {
   public:
     MythCommFlagPlayer(PlayerFlags flags = kNoFlags) : MythPlayer(flags) { }
     bool RebuildSeekTable(bool showPercentage = true, StatusCallback cb = NULL,
                           void* cbData = NULL);
+
+    PlayerContext *CreateSegmentPlayer(void);
+    long long GetKeyframeBefore(long long frame);
 };
 
 #endif // MYTHCOMMFLAGPLAYER_H
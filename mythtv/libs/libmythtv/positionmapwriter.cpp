@@ -0,0 +1,248 @@
+// -*- Mode: c++ -*-
+
+#include <algorithm> // for max
+using namespace std;
+
+#include "positionmapwriter.h"
+#include "mythlogging.h"
+#include "mythdbcon.h"
+#include "mythdb.h"
+
+#define LOC QString("PosMapWriter: ")
+
+QMutex             PositionMapWriter::s_writerLock;
+PositionMapWriter *PositionMapWriter::s_writer = NULL;
+
+PositionMapWriter::PositionMapWriter() :
+    MThread("PosMapWriter"),
+    m_queuedRows(0), m_enqueued(0), m_completed(0),
+    m_flushing(false), m_stop(false),
+    m_rowsWritten(0), m_statements(0),
+    m_maxQueuedRows(0), m_maxLatency(0)
+{
+}
+
+PositionMapWriter::~PositionMapWriter()
+{
+    wait();
+}
+
+PositionMapWriter *PositionMapWriter::GetWriter(void)
+{
+    QMutexLocker locker(&s_writerLock);
+    if (!s_writer)
+    {
+        s_writer = new PositionMapWriter();
+        s_writer->start();
+    }
+    return s_writer;
+}
+
+/** \brief Queues a position map delta for the recordedseek table.
+ *
+ *   This only blocks for as long as it takes to copy the delta.
+ */
+void PositionMapWriter::Enqueue(uint chanid, const QDateTime &recstartts,
+                                const frm_pos_map_t &delta, MarkTypes type)
+{
+    if (delta.empty())
+        return;
+
+    PositionMapWriter *writer = GetWriter();
+    QMutexLocker locker(&writer->m_lock);
+
+    if (writer->m_queue.empty())
+        writer->m_oldest.start();
+
+    writer->m_queue.push_back(Delta());
+    Delta &d = writer->m_queue.back();
+    d.chanid     = chanid;
+    d.recstartts = recstartts;
+    d.type       = type;
+    d.map        = delta;
+
+    writer->m_queuedRows += delta.size();
+    writer->m_maxQueuedRows =
+        max(writer->m_maxQueuedRows, writer->m_queuedRows);
+    writer->m_enqueued++;
+
+    if (writer->m_queuedRows >= kMaxQueuedRows)
+        writer->m_wait.wakeAll();
+}
+
+/// \brief Waits until every delta queued so far has been written.
+void PositionMapWriter::Flush(void)
+{
+    s_writerLock.lock();
+    PositionMapWriter *writer = s_writer;
+    s_writerLock.unlock();
+
+    if (!writer)
+        return;
+
+    QMutexLocker locker(&writer->m_lock);
+    uint64_t target = writer->m_enqueued;
+    if (writer->m_completed >= target)
+        return;
+
+    writer->m_flushing = true;
+    writer->m_wait.wakeAll();
+    while (writer->m_completed < target)
+        writer->m_written.wait(&writer->m_lock);
+}
+
+/// \brief Writes anything still queued and stops the writer thread.
+void PositionMapWriter::Shutdown(void)
+{
+    QMutexLocker locker(&s_writerLock);
+    if (!s_writer)
+        return;
+
+    s_writer->m_lock.lock();
+    s_writer->m_stop = true;
+    s_writer->m_wait.wakeAll();
+    s_writer->m_lock.unlock();
+
+    s_writer->wait();
+    delete s_writer;
+    s_writer = NULL;
+}
+
+void PositionMapWriter::run(void)
+{
+    RunProlog();
+
+    QMutexLocker locker(&m_lock);
+    while (true)
+    {
+        if (m_queue.empty())
+        {
+            m_flushing = false;
+            if (m_stop)
+                break;
+            m_wait.wait(&m_lock);
+            continue;
+        }
+
+        int age = m_oldest.elapsed();
+        bool due = m_flushing || m_stop ||
+            (m_queuedRows >= kMaxQueuedRows) || (age >= kMaxDelay);
+        if (!due)
+        {
+            m_wait.wait(&m_lock, max(kMaxDelay - age, 1));
+            continue;
+        }
+
+        QList<Delta> batch = m_queue;
+        m_queue.clear();
+        uint     rows     = m_queuedRows;
+        uint64_t target   = m_enqueued;
+        m_queuedRows = 0;
+        locker.unlock();
+
+        // Merge the deltas of each recording and mark type, so each
+        // gets as few INSERTs as possible.
+        QList<Delta> merged;
+        QList<Delta>::const_iterator it = batch.begin();
+        for (; it != batch.end(); ++it)
+        {
+            QList<Delta>::iterator mit = merged.begin();
+            for (; mit != merged.end(); ++mit)
+            {
+                if ((*mit).chanid == (*it).chanid &&
+                    (*mit).type   == (*it).type   &&
+                    (*mit).recstartts == (*it).recstartts)
+                {
+                    break;
+                }
+            }
+
+            if (mit == merged.end())
+            {
+                merged.push_back(*it);
+                continue;
+            }
+
+            frm_pos_map_t::const_iterator pit = (*it).map.begin();
+            for (; pit != (*it).map.end(); ++pit)
+                (*mit).map.insert(pit.key(), *pit);
+        }
+
+        MythTimer t;
+        t.start();
+        uint statements = 0;
+        for (QList<Delta>::const_iterator mit = merged.begin();
+             mit != merged.end(); ++mit)
+        {
+            WriteDelta(*mit, statements);
+        }
+        int latency = t.elapsed();
+
+        locker.relock();
+        m_completed    = target;
+        m_rowsWritten += rows;
+        m_statements  += statements;
+        m_maxLatency   = max(m_maxLatency, latency);
+
+        LOG(VB_RECORD, LOG_DEBUG, LOC +
+            QString("Wrote %1 rows for %2 recordings in %3 statements, "
+                    "%4 ms; %5 rows queued since")
+            .arg(rows).arg(merged.size()).arg(statements)
+            .arg(latency).arg(m_queuedRows));
+        if (latency > 1000)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("Writing %1 position map rows took %2 ms")
+                .arg(rows).arg(latency));
+        }
+
+        m_written.wakeAll();
+    }
+
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Wrote %1 rows in %2 statements; "
+                "max queue depth %3 rows, max insert latency %4 ms")
+        .arg(m_rowsWritten).arg(m_statements)
+        .arg(m_maxQueuedRows).arg(m_maxLatency));
+
+    locker.unlock();
+    RunEpilog();
+}
+
+/// Writes one merged delta with multi-row INSERTs. Existing rows are
+/// updated, so a keyframe that is saved twice does not fail the batch.
+bool PositionMapWriter::WriteDelta(const Delta &delta, uint &statements)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    frm_pos_map_t::const_iterator it = delta.map.begin();
+    while (it != delta.map.end())
+    {
+        QString values;
+        for (uint n = 0; n < kRowsPerInsert && it != delta.map.end();
+             ++n, ++it)
+        {
+            values += QString("%1(:CHANID, :STARTTIME, :TYPE, %2, %3)")
+                .arg(n ? "," : "")
+                .arg((quint64)it.key()).arg((quint64)*it);
+        }
+
+        query.prepare(
+            "INSERT INTO "
+            "recordedseek (chanid, starttime, type, mark, offset) "
+            "VALUES " + values + " "
+            "ON DUPLICATE KEY UPDATE offset = VALUES(offset)");
+        query.bindValue(":CHANID",    delta.chanid);
+        query.bindValue(":STARTTIME", delta.recstartts);
+        query.bindValue(":TYPE",      delta.type);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("position map writer insert", query);
+            return false;
+        }
+        statements++;
+    }
+
+    return true;
+}
@@ -0,0 +1,86 @@
+// -*- Mode: c++ -*-
+#ifndef _POSITION_MAP_WRITER_H_
+#define _POSITION_MAP_WRITER_H_
+
+#include <stdint.h>
+
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QMutex>
+#include <QList>
+
+#include "programtypes.h"
+#include "mythtimer.h"
+#include "mythtvexp.h"
+#include "mthread.h"
+
+/** \class PositionMapWriter
+ *  \brief Writes the recordedseek position map deltas of all recorders
+ *         from one background thread.
+ *
+ *   Recorders queue their deltas with Enqueue() instead of inserting
+ *   each keyframe from their own thread. The writer merges the deltas
+ *   of each recording and writes them with multi-row INSERTs once
+ *   enough rows are queued or the oldest delta is too old, so a busy
+ *   database no longer stalls the recorders. Flush() waits for the
+ *   deltas already queued to reach the database, recorders call it
+ *   when a recording ends.
+ */
+class MTV_PUBLIC PositionMapWriter : public MThread
+{
+  public:
+    static void Enqueue(uint chanid, const QDateTime &recstartts,
+                        const frm_pos_map_t &delta, MarkTypes type);
+    static void Flush(void);
+    static void Shutdown(void);
+
+  protected:
+    virtual void run(void); // MThread
+
+  private:
+    PositionMapWriter();
+    ~PositionMapWriter();
+
+    class Delta
+    {
+      public:
+        Delta() : chanid(0), type(MARK_UNSET) {}
+        uint          chanid;
+        QDateTime     recstartts;
+        MarkTypes     type;
+        frm_pos_map_t map;
+    };
+
+    static PositionMapWriter *GetWriter(void);
+    bool WriteDelta(const Delta &delta, uint &statements);
+
+  private:
+    static QMutex             s_writerLock;
+    static PositionMapWriter *s_writer;
+
+    QMutex          m_lock;
+    QWaitCondition  m_wait;         ///< wakes the writer thread
+    QWaitCondition  m_written;      ///< wakes threads waiting in Flush()
+    QList<Delta>    m_queue;        ///< protected by m_lock
+    uint            m_queuedRows;   ///< protected by m_lock
+    MythTimer       m_oldest;       ///< age of the oldest queued delta
+    uint64_t        m_enqueued;     ///< deltas ever queued
+    uint64_t        m_completed;    ///< deltas ever written (or failed)
+    bool            m_flushing;
+    bool            m_stop;
+
+    // statistics, only updated by the writer thread under m_lock
+    uint64_t        m_rowsWritten;
+    uint64_t        m_statements;
+    uint            m_maxQueuedRows;
+    int             m_maxLatency;
+
+    /// Write once this many rows are queued
+    static const uint kMaxQueuedRows = 2000;
+    /// Write once the oldest queued delta is this old, in milliseconds
+    static const int  kMaxDelay      = 2000;
+    /// Rows per INSERT statement
+    static const uint kRowsPerInsert = 1000;
+};
+
+#endif // _POSITION_MAP_WRITER_H_
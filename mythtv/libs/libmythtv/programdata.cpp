@@ -124,6 +124,12 @@ uint DBPerson::InsertCreditsDB(MSqlQuery &query, uint personid, uint chanid,
     return 0;
 }
 
+DBEvent::DBEvent(const DBEvent &other) :
+    credits(NULL)
+{
+    *this = other;
+}
+
 DBEvent &DBEvent::operator=(const DBEvent &other)
 {
     if (this == &other)
@@ -240,10 +246,21 @@ uint DBEvent::UpdateDB(
     }
 }
 
+/** \brief Loads the programs overlapping this event.
+ *
+ *  With \a any_overlap the selection also includes programs which
+ *  start before and end after this event, UpdateDBBatch() uses that
+ *  to load the programs of a whole batch window at once.
+ */
 uint DBEvent::GetOverlappingPrograms(
-    MSqlQuery &query, uint chanid, vector<DBEvent> &programs) const
+    MSqlQuery &query, uint chanid, vector<DBEvent> &programs,
+    bool any_overlap) const
 {
     uint count = 0;
+    QString overlap = any_overlap ?
+        "      ( starttime <= :ETIME1 AND endtime >= :STIME2 )" :
+        "      ( ( starttime >= :STIME1 AND starttime <  :ETIME1 ) OR "
+        "        ( endtime   >  :STIME2 AND endtime   <= :ETIME2 ) )";
     query.prepare(
         "SELECT title,          subtitle,      description, "
         "       category,       category_type, "
@@ -257,14 +274,14 @@ uint DBEvent::GetOverlappingPrograms(
         "       stars+0 "
         "FROM program "
         "WHERE chanid   = :CHANID AND "
-        "      manualid = 0       AND "
-        "      ( ( starttime >= :STIME1 AND starttime <  :ETIME1 ) OR "
-        "        ( endtime   >  :STIME2 AND endtime   <= :ETIME2 ) )");
+        "      manualid = 0       AND " + overlap);
     query.bindValue(":CHANID", chanid);
-    query.bindValue(":STIME1", starttime);
+    if (!any_overlap)
+        query.bindValue(":STIME1", starttime);
     query.bindValue(":ETIME1", endtime);
     query.bindValue(":STIME2", starttime);
-    query.bindValue(":ETIME2", endtime);
+    if (!any_overlap)
+        query.bindValue(":ETIME2", endtime);
 
     if (!query.exec())
     {
@@ -466,65 +483,102 @@ uint DBEvent::UpdateDB(
     return UpdateDB(q, chanid, p[match]);
 }
 
-uint DBEvent::UpdateDB(
-    MSqlQuery &query, uint chanid, const DBEvent &match) const
+/** \brief Fills in \a merged with the data of this event, using the data
+ *         of the existing \a match to fill in anything we lack.
+ *
+ *  The start and end time are always taken from this event, while the
+ *  star rating, which the EIT never supplies, is kept from the match.
+ */
+void DBEvent::Merge(const DBEvent &match, DBEvent &merged) const
 {
-    QString  ltitle     = title;
-    QString  lsubtitle  = subtitle;
-    QString  ldesc      = description;
-    QString  lcategory  = category;
-    uint16_t lairdate   = airdate;
-    QString  lprogramId = programId;
-    QString  lseriesId  = seriesId;
-    QDate loriginalairdate = originalairdate;
+    merged.title           = title;
+    merged.subtitle        = subtitle;
+    merged.description     = description;
+    merged.category        = category;
+    merged.starttime       = starttime;
+    merged.endtime         = endtime;
+    merged.airdate         = airdate;
+    merged.originalairdate = originalairdate;
+    merged.programId       = programId;
+    merged.seriesId        = seriesId;
+    merged.stars           = match.stars;
 
-    if (match.title.length() >= ltitle.length())
-        ltitle = match.title;
+    if (match.title.length() >= merged.title.length())
+        merged.title = match.title;
 
-    if (match.subtitle.length() >= lsubtitle.length())
-        lsubtitle = match.subtitle;
+    if (match.subtitle.length() >= merged.subtitle.length())
+        merged.subtitle = match.subtitle;
 
-    if (match.description.length() >= ldesc.length())
-        ldesc = match.description;
+    if (match.description.length() >= merged.description.length())
+        merged.description = match.description;
 
-    if (lcategory.isEmpty() && !match.category.isEmpty())
-        lcategory = match.category;
+    if (merged.category.isEmpty() && !match.category.isEmpty())
+        merged.category = match.category;
 
-    if (!lairdate && !match.airdate)
-        lairdate = match.airdate;
+    if (!merged.airdate && !match.airdate)
+        merged.airdate = match.airdate;
 
-    if (!loriginalairdate.isValid() && match.originalairdate.isValid())
-        loriginalairdate = match.originalairdate;
+    if (!merged.originalairdate.isValid() && match.originalairdate.isValid())
+        merged.originalairdate = match.originalairdate;
 
-    if (lprogramId.isEmpty() && !match.programId.isEmpty())
-        lprogramId = match.programId;
+    if (merged.programId.isEmpty() && !match.programId.isEmpty())
+        merged.programId = match.programId;
 
-    if (lseriesId.isEmpty() && !match.seriesId.isEmpty())
-        lseriesId = match.seriesId;
+    if (merged.seriesId.isEmpty() && !match.seriesId.isEmpty())
+        merged.seriesId = match.seriesId;
 
-    uint tmp = categoryType;
+    merged.categoryType = categoryType;
     if (!categoryType && match.categoryType)
-        tmp = match.categoryType;
-
-    QString lcattype = myth_category_type_to_string(tmp);
+        merged.categoryType = match.categoryType;
 
-    unsigned char lsubtype = subtitleType | match.subtitleType;
-    unsigned char laudio   = audioProps   | match.audioProps;
-    unsigned char lvideo   = videoProps   | match.videoProps;
+    merged.subtitleType = subtitleType | match.subtitleType;
+    merged.audioProps   = audioProps   | match.audioProps;
+    merged.videoProps   = videoProps   | match.videoProps;
 
-    uint lpartnumber =
+    merged.partnumber =
         (!partnumber && match.partnumber) ? match.partnumber : partnumber;
-    uint lparttotal =
+    merged.parttotal =
         (!parttotal  && match.parttotal ) ? match.parttotal  : parttotal;
 
-    bool lpreviouslyshown = previouslyshown | match.previouslyshown;
+    merged.previouslyshown = previouslyshown | match.previouslyshown;
 
-    uint32_t llistingsource = listingsource | match.listingsource;
+    merged.listingsource = listingsource | match.listingsource;
 
-    QString lsyndicatedepisodenumber = syndicatedepisodenumber;
-    if (lsyndicatedepisodenumber.isEmpty() &&
+    merged.syndicatedepisodenumber = syndicatedepisodenumber;
+    if (merged.syndicatedepisodenumber.isEmpty() &&
         !match.syndicatedepisodenumber.isEmpty())
-        lsyndicatedepisodenumber = match.syndicatedepisodenumber;
+        merged.syndicatedepisodenumber = match.syndicatedepisodenumber;
+}
+
+uint DBEvent::UpdateDB(
+    MSqlQuery &query, uint chanid, const DBEvent &match) const
+{
+    DBEvent merged(listingsource);
+    Merge(match, merged);
+
+    QString  ltitle     = merged.title;
+    QString  lsubtitle  = merged.subtitle;
+    QString  ldesc      = merged.description;
+    QString  lcategory  = merged.category;
+    uint16_t lairdate   = merged.airdate;
+    QString  lprogramId = merged.programId;
+    QString  lseriesId  = merged.seriesId;
+    QDate loriginalairdate = merged.originalairdate;
+
+    QString lcattype = myth_category_type_to_string(merged.categoryType);
+
+    unsigned char lsubtype = merged.subtitleType;
+    unsigned char laudio   = merged.audioProps;
+    unsigned char lvideo   = merged.videoProps;
+
+    uint lpartnumber = merged.partnumber;
+    uint lparttotal  = merged.parttotal;
+
+    bool lpreviouslyshown = merged.previouslyshown;
+
+    uint32_t llistingsource = merged.listingsource;
+
+    QString lsyndicatedepisodenumber = merged.syndicatedepisodenumber;
 
     query.prepare(
         "UPDATE program "
@@ -750,6 +804,523 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid) const
     return 1;
 }
 
+/// In memory copy of a program row used by DBEvent::UpdateDBBatch()
+class DBEventBatchRow
+{
+  public:
+    DBEventBatchRow() :
+        prog(kListingSourceEIT), in_db(false), deleted(false), dirty(false) {}
+
+    DBEvent   prog;      ///< current contents of the row
+    QDateTime dbstart;   ///< starttime of the row in the DB, if in_db
+    QDateTime dbend;     ///< endtime of the row in the DB, if in_db
+    bool      in_db;     ///< row was loaded from the DB
+    bool      deleted;   ///< row must go
+    bool      dirty;     ///< row contents must be written
+    vector<const DBEvent*> credits; ///< events whose credits go to this row
+};
+typedef vector<DBEventBatchRow*> DBEventBatchRows;
+
+static bool same_program_data(const DBEvent &a, const DBEvent &b)
+{
+    return (a.title                   == b.title                   &&
+            a.subtitle                == b.subtitle                &&
+            a.description             == b.description             &&
+            a.category                == b.category                &&
+            a.categoryType            == b.categoryType            &&
+            a.starttime               == b.starttime               &&
+            a.endtime                 == b.endtime                 &&
+            a.subtitleType            == b.subtitleType            &&
+            a.audioProps              == b.audioProps              &&
+            a.videoProps              == b.videoProps              &&
+            a.partnumber              == b.partnumber              &&
+            a.parttotal               == b.parttotal               &&
+            a.syndicatedepisodenumber == b.syndicatedepisodenumber &&
+            a.airdate                 == b.airdate                 &&
+            a.originalairdate         == b.originalairdate         &&
+            a.listingsource           == b.listingsource           &&
+            a.seriesId                == b.seriesId                &&
+            a.programId               == b.programId               &&
+            a.previouslyshown         == b.previouslyshown);
+}
+
+/// Removes or trims row \a r so it no longer overlaps \a ev,
+/// this is the in memory version of DBEvent::MoveOutOfTheWayDB().
+static void move_out_of_the_way(const DBEvent &ev, DBEventBatchRow &r)
+{
+    DBEvent &prog = r.prog;
+    if (prog.starttime >= ev.starttime && prog.endtime <= ev.endtime)
+    {
+        // inside current program
+        r.deleted = true;
+    }
+    else if (prog.starttime < ev.starttime && prog.endtime > ev.starttime)
+    {
+        // starts before, but ends during our program
+        prog.endtime = ev.starttime;
+    }
+    else if (prog.starttime < ev.endtime && prog.endtime > ev.endtime)
+    {
+        // starts during, but ends after our program
+        prog.starttime = ev.endtime;
+    }
+}
+
+static bool delete_programs(MSqlQuery &query, uint chanid,
+                            const QList<QDateTime> &starts)
+{
+    if (starts.empty())
+        return true;
+
+    QString list;
+    MSqlBindings bindings;
+    for (int i = 0; i < starts.size(); i++)
+    {
+        QString key = QString(":STARTTIME%1").arg(i);
+        list += (i ? "," : "") + key;
+        bindings[key] = starts[i];
+    }
+    bindings[":CHANID"] = chanid;
+
+    query.prepare(
+        "DELETE from program "
+        "WHERE chanid    = :CHANID AND "
+        "      starttime IN (" + list + ")");
+    query.bindValues(bindings);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("delete_programs", query);
+        return false;
+    }
+
+    query.prepare(
+        "DELETE from credits "
+        "WHERE chanid    = :CHANID AND "
+        "      starttime IN (" + list + ")");
+    query.bindValues(bindings);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("delete_programs credits", query);
+        return false;
+    }
+
+    return true;
+}
+
+/// Writes \a rows with one multi-row INSERT, existing rows are updated in
+/// place so columns the EIT knows nothing about are left alone.
+static bool upsert_programs(MSqlQuery &query, uint chanid,
+                            const DBEventBatchRows &rows,
+                            uint begin, uint end)
+{
+    if (begin >= end)
+        return true;
+
+    QString values;
+    MSqlBindings bindings;
+    for (uint i = begin; i < end; i++)
+    {
+        const DBEvent &p = rows[i]->prog;
+        QString n = QString::number(i - begin);
+
+        values += QString(
+            "%1(:CHANID, :TITLE%2, :SUBTITLE%2, :DESCRIPTION%2, "
+            " :CATEGORY%2, :CATTYPE%2, :STARTTIME%2, :ENDTIME%2, "
+            " :CC%2, :STEREO%2, :HDTV%2, :HASSUBTITLES%2, "
+            " :SUBTYPES%2, :AUDIOPROP%2, :VIDEOPROP%2, "
+            " :STARS%2, :PARTNUMBER%2, :PARTTOTAL%2, :SYNDICATENO%2, "
+            " :AIRDATE%2, :ORIGAIRDATE%2, :LSOURCE%2, "
+            " :SERIESID%2, :PROGRAMID%2, :PREVSHOWN%2)")
+            .arg((i == begin) ? "" : ",").arg(n);
+
+        bindings[":TITLE"       + n] = denullify(p.title);
+        bindings[":SUBTITLE"    + n] = denullify(p.subtitle);
+        bindings[":DESCRIPTION" + n] = denullify(p.description);
+        bindings[":CATEGORY"    + n] = denullify(p.category);
+        bindings[":CATTYPE"     + n] =
+            myth_category_type_to_string(p.categoryType);
+        bindings[":STARTTIME"   + n] = p.starttime;
+        bindings[":ENDTIME"     + n] = p.endtime;
+        bindings[":CC"          + n] = (p.subtitleType & SUB_HARDHEAR) != 0;
+        bindings[":STEREO"      + n] = (p.audioProps   & AUD_STEREO)   != 0;
+        bindings[":HDTV"        + n] = (p.videoProps   & VID_HDTV)     != 0;
+        bindings[":HASSUBTITLES"+ n] = (p.subtitleType & SUB_NORMAL)   != 0;
+        bindings[":SUBTYPES"    + n] = p.subtitleType;
+        bindings[":AUDIOPROP"   + n] = p.audioProps;
+        bindings[":VIDEOPROP"   + n] = p.videoProps;
+        bindings[":STARS"       + n] = p.stars;
+        bindings[":PARTNUMBER"  + n] = p.partnumber;
+        bindings[":PARTTOTAL"   + n] = p.parttotal;
+        bindings[":SYNDICATENO" + n] = denullify(p.syndicatedepisodenumber);
+        bindings[":AIRDATE"     + n] =
+            p.airdate ? QString::number(p.airdate) : "0000";
+        bindings[":ORIGAIRDATE" + n] = p.originalairdate;
+        bindings[":LSOURCE"     + n] = p.listingsource;
+        bindings[":SERIESID"    + n] = denullify(p.seriesId);
+        bindings[":PROGRAMID"   + n] = denullify(p.programId);
+        bindings[":PREVSHOWN"   + n] = p.previouslyshown;
+    }
+    bindings[":CHANID"] = chanid;
+
+    query.prepare(
+        "INSERT INTO program ("
+        "  chanid,         title,          subtitle,        description, "
+        "  category,       category_type, "
+        "  starttime,      endtime, "
+        "  closecaptioned, stereo,         hdtv,            subtitled, "
+        "  subtitletypes,  audioprop,      videoprop, "
+        "  stars,          partnumber,     parttotal, "
+        "  syndicatedepisodenumber, "
+        "  airdate,        originalairdate,listingsource, "
+        "  seriesid,       programid,      previouslyshown ) "
+        "VALUES " + values + " "
+        "ON DUPLICATE KEY UPDATE "
+        "  title          = VALUES(title), "
+        "  subtitle       = VALUES(subtitle), "
+        "  description    = VALUES(description), "
+        "  category       = VALUES(category), "
+        "  category_type  = VALUES(category_type), "
+        "  endtime        = VALUES(endtime), "
+        "  closecaptioned = VALUES(closecaptioned), "
+        "  stereo         = VALUES(stereo), "
+        "  hdtv           = VALUES(hdtv), "
+        "  subtitled      = VALUES(subtitled), "
+        "  subtitletypes  = VALUES(subtitletypes), "
+        "  audioprop      = VALUES(audioprop), "
+        "  videoprop      = VALUES(videoprop), "
+        "  partnumber     = VALUES(partnumber), "
+        "  parttotal      = VALUES(parttotal), "
+        "  syndicatedepisodenumber = VALUES(syndicatedepisodenumber), "
+        "  airdate        = VALUES(airdate), "
+        "  originalairdate= VALUES(originalairdate), "
+        "  listingsource  = VALUES(listingsource), "
+        "  seriesid       = VALUES(seriesid), "
+        "  programid      = VALUES(programid), "
+        "  previouslyshown= VALUES(previouslyshown)");
+    query.bindValues(bindings);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("upsert_programs", query);
+        return false;
+    }
+
+    return true;
+}
+
+/** \brief Writes the changed rows of a batch, see DBEvent::UpdateDBBatch().
+ *
+ *  Moving a row changes its primary key, so the moves are ordered such
+ *  that a row only moves once no other row occupies its new start time.
+ *  Nothing is written if no such order exists.
+ */
+static bool write_batch(MSqlQuery &query, uint chanid,
+                        const DBEventBatchRows &rows)
+{
+    static const uint kMaxRowsPerInsert = 50;
+
+    QList<QDateTime> deletes;
+    DBEventBatchRows moves, upserts;
+    QMap<QDateTime, const DBEventBatchRow*> occupied;
+    for (uint i = 0; i < rows.size(); i++)
+    {
+        DBEventBatchRow *r = rows[i];
+        if (r->deleted)
+        {
+            if (r->in_db)
+                deletes.push_back(r->dbstart);
+            continue;
+        }
+
+        if (r->in_db)
+            occupied[r->dbstart] = r;
+
+        if (r->in_db && (r->prog.starttime != r->dbstart ||
+                         r->prog.endtime   != r->dbend))
+        {
+            moves.push_back(r);
+        }
+
+        if (r->dirty)
+            upserts.push_back(r);
+    }
+
+    DBEventBatchRows ordered;
+    while (!moves.empty())
+    {
+        bool progress = false;
+        for (uint i = 0; i < moves.size();)
+        {
+            DBEventBatchRow *r = moves[i];
+            const DBEventBatchRow *o = occupied.value(r->prog.starttime, NULL);
+            if (o && o != r)
+            {
+                i++;
+                continue;
+            }
+
+            occupied.remove(r->dbstart);
+            occupied[r->prog.starttime] = r;
+            ordered.push_back(r);
+            moves.erase(moves.begin() + i);
+            progress = true;
+        }
+
+        if (!progress)
+        {
+            LOG(VB_EIT, LOG_WARNING,
+                QString("EIT: can not move %1 programs on channel %2 "
+                        "without a start time collision")
+                    .arg(moves.size()).arg(chanid));
+            return false;
+        }
+    }
+
+    if (!delete_programs(query, chanid, deletes))
+        return false;
+
+    for (uint i = 0; i < ordered.size(); i++)
+    {
+        if (!change_program(query, chanid, ordered[i]->dbstart,
+                            ordered[i]->prog.starttime,
+                            ordered[i]->prog.endtime))
+        {
+            return false;
+        }
+    }
+
+    for (uint i = 0; i < upserts.size(); i += kMaxRowsPerInsert)
+    {
+        uint end = min((uint)upserts.size(), i + kMaxRowsPerInsert);
+        if (!upsert_programs(query, chanid, upserts, i, end))
+            return false;
+    }
+
+    for (uint i = 0; i < rows.size(); i++)
+    {
+        const DBEventBatchRow *r = rows[i];
+        for (uint j = 0; !r->deleted && j < r->credits.size(); j++)
+        {
+            const DBCredits &credits = *r->credits[j]->credits;
+            for (uint k = 0; k < credits.size(); k++)
+                credits[k].InsertDB(query, chanid, r->prog.starttime);
+        }
+    }
+
+    return true;
+}
+
+/** \brief Batch version of UpdateDB(MSqlQuery&,uint,int) for many events
+ *         on one channel.
+ *
+ *  Instead of looking up and rewriting the overlapping programs of each
+ *  event individually, the programs overlapping a group of events are
+ *  loaded with one query and matched against the events in memory.
+ *  Afterwards only the rows which actually changed are written, new and
+ *  updated rows with multi-row INSERTs. The events are applied in the
+ *  order given, so the end result is the same as calling UpdateDB() on
+ *  each in turn.
+ *
+ *  The tables are only locked for one group of events at a time, so
+ *  readers never wait for a whole batch. If a group can not be written
+ *  its events are written one by one with UpdateDB() instead, which
+ *  also repairs whatever part of the group had been written already.
+ *
+ *  \return Number of events successfully written.
+ */
+uint DBEvent::UpdateDBBatch(MSqlQuery &query, uint chanid,
+                            const vector<const DBEvent*> &events,
+                            int match_threshold)
+{
+    static const uint kMaxEventsPerLock = 50;
+
+    uint count = 0;
+    for (uint i = 0; i < events.size(); i += kMaxEventsPerLock)
+    {
+        vector<const DBEvent*> part(
+            events.begin() + i,
+            events.begin() + min((uint)events.size(), i + kMaxEventsPerLock));
+
+        bool locked = LockTablesForBatch(query);
+        bool ok = UpdateDBBatchPart(query, chanid, part, match_threshold);
+        if (locked)
+            UnlockTablesForBatch(query);
+
+        if (ok)
+        {
+            count += part.size();
+            continue;
+        }
+
+        LOG(VB_EIT, LOG_WARNING,
+            QString("EIT: batch update of %1 events on channel %2 failed, "
+                    "writing them one by one").arg(part.size()).arg(chanid));
+        for (uint j = 0; j < part.size(); j++)
+            count += part[j]->UpdateDB(query, chanid, match_threshold);
+    }
+
+    return count;
+}
+
+/** \brief Applies one group of events for UpdateDBBatch().
+ *
+ *  The caller is expected to hold a write lock on the program, credits
+ *  and people tables, see LockTablesForBatch().
+ *
+ *  \return false if any write failed, or the program rows can not be
+ *           moved without colliding.
+ */
+bool DBEvent::UpdateDBBatchPart(MSqlQuery &query, uint chanid,
+                                const vector<const DBEvent*> &events,
+                                int match_threshold)
+{
+    if (events.empty())
+        return true;
+
+    QDateTime wstart = events[0]->starttime;
+    QDateTime wend   = events[0]->endtime;
+    for (uint i = 1; i < events.size(); i++)
+    {
+        wstart = min(wstart, events[i]->starttime);
+        wend   = max(wend,   events[i]->endtime);
+    }
+
+    // Load all programs that may overlap any event of this batch
+    vector<DBEvent> programs;
+    DBEvent window(kListingSourceEIT);
+    window.starttime = wstart;
+    window.endtime   = wend;
+    window.GetOverlappingPrograms(query, chanid, programs, true);
+
+    DBEventBatchRows rows;
+    for (uint i = 0; i < programs.size(); i++)
+    {
+        DBEventBatchRow *r = new DBEventBatchRow();
+        r->prog    = programs[i];
+        r->dbstart = programs[i].starttime;
+        r->dbend   = programs[i].endtime;
+        r->in_db   = true;
+        rows.push_back(r);
+    }
+
+    for (uint e = 0; e < events.size(); e++)
+    {
+        const DBEvent &ev = *events[e];
+
+        // same selection as GetOverlappingPrograms() does for this event
+        vector<DBEventBatchRow*> overlap;
+        vector<DBEvent> candidates;
+        for (uint i = 0; i < rows.size(); i++)
+        {
+            const DBEvent &p = rows[i]->prog;
+            if (rows[i]->deleted)
+                continue;
+            if ((p.starttime >= ev.starttime && p.starttime <  ev.endtime) ||
+                (p.endtime   >  ev.starttime && p.endtime   <= ev.endtime))
+            {
+                overlap.push_back(rows[i]);
+                candidates.push_back(p);
+            }
+        }
+
+        int match = -1;
+        if (!candidates.empty())
+        {
+            int score = ev.GetMatch(candidates, match);
+            if (score < match_threshold)
+            {
+                if (match >= 0)
+                {
+                    LOG(VB_EIT, LOG_DEBUG,
+                        QString("EIT: reject match[%1]: %2 '%3' vs. '%4'")
+                            .arg(match).arg(score).arg(ev.title)
+                            .arg(candidates[match].title));
+                }
+                match = -1;
+            }
+            else
+            {
+                LOG(VB_EIT, LOG_DEBUG,
+                    QString("EIT: accept match[%1]: %2 '%3' vs. '%4'")
+                        .arg(match).arg(score).arg(ev.title)
+                        .arg(candidates[match].title));
+            }
+        }
+
+        for (uint i = 0; i < overlap.size(); i++)
+        {
+            if (i != (uint)match)
+                move_out_of_the_way(ev, *overlap[i]);
+        }
+
+        DBEventBatchRow *r = NULL;
+        if (match >= 0)
+        {
+            r = overlap[match];
+            DBEvent merged(ev.listingsource);
+            ev.Merge(r->prog, merged);
+            if (!same_program_data(merged, r->prog))
+            {
+                r->prog  = merged;
+                r->dirty = true;
+            }
+        }
+        else
+        {
+            // REPLACE INTO semantics, an insert supersedes a row that
+            // has the same start time
+            for (uint i = 0; i < rows.size(); i++)
+            {
+                if (!rows[i]->deleted &&
+                    rows[i]->prog.starttime == ev.starttime)
+                {
+                    rows[i]->deleted = true;
+                }
+            }
+
+            r = new DBEventBatchRow();
+            r->prog  = ev;
+            r->dirty = true;
+            rows.push_back(r);
+        }
+
+        if (ev.credits)
+            r->credits.push_back(&ev);
+    }
+
+    bool ok = write_batch(query, chanid, rows);
+
+    for (uint i = 0; i < rows.size(); i++)
+        delete rows[i];
+
+    return ok;
+}
+
+/** \brief Takes the table locks UpdateDBBatchPart() relies on.
+ *
+ *  The program table is MyISAM, so there are no transactions to group
+ *  the batch with. Locking the tables instead keeps readers from seeing
+ *  a half applied batch and lets MySQL defer the index flushes until
+ *  UnlockTablesForBatch() is called.
+ */
+bool DBEvent::LockTablesForBatch(MSqlQuery &query)
+{
+    if (!query.exec("LOCK TABLES program WRITE, credits WRITE, people WRITE"))
+    {
+        MythDB::DBError("LockTablesForBatch", query);
+        return false;
+    }
+    return true;
+}
+
+void DBEvent::UnlockTablesForBatch(MSqlQuery &query)
+{
+    if (!query.exec("UNLOCK TABLES"))
+        MythDB::DBError("UnlockTablesForBatch", query);
+}
+
 ProgInfo::ProgInfo(const ProgInfo &other) :
     DBEvent(other.listingsource)
 {
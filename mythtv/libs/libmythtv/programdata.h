@@ -120,12 +120,16 @@ class MTV_PUBLIC DBEvent
     {
     }
 
+    DBEvent(const DBEvent &other);
     virtual ~DBEvent() { delete credits; }
 
     void AddPerson(DBPerson::Role, const QString &name);
     void AddPerson(const QString &role, const QString &name);
 
     uint UpdateDB(MSqlQuery &query, uint chanid, int match_threshold) const;
+    static uint UpdateDBBatch(MSqlQuery &query, uint chanid,
+                              const vector<const DBEvent*> &events,
+                              int match_threshold);
 
     bool HasCredits(void) const { return credits; }
     bool HasTimeConflict(const DBEvent &other) const;
@@ -133,14 +137,21 @@ class MTV_PUBLIC DBEvent
     DBEvent &operator=(const DBEvent&);
 
   protected:
+    static bool UpdateDBBatchPart(MSqlQuery &query, uint chanid,
+                                  const vector<const DBEvent*> &events,
+                                  int match_threshold);
+    static bool LockTablesForBatch(MSqlQuery &query);
+    static void UnlockTablesForBatch(MSqlQuery &query);
     uint GetOverlappingPrograms(
-        MSqlQuery&, uint chanid, vector<DBEvent> &programs) const;
+        MSqlQuery&, uint chanid, vector<DBEvent> &programs,
+        bool any_overlap = false) const;
     int  GetMatch(
         const vector<DBEvent> &programs, int &bestmatch) const;
     uint UpdateDB(
         MSqlQuery&, uint chanid, const vector<DBEvent> &p, int match) const;
     uint UpdateDB(
         MSqlQuery&, uint chanid, const DBEvent &match) const;
+    void Merge(const DBEvent &match, DBEvent &merged) const;
     bool MoveOutOfTheWayDB(
         MSqlQuery&, uint chanid, const DBEvent &nonmatch) const;
     virtual uint InsertDB(MSqlQuery&, uint chanid) const;
@@ -4,6 +4,7 @@
 using namespace std;
 
 #include "NuppelVideoRecorder.h"
+#include "positionmapwriter.h"
 #include "firewirerecorder.h"
 #include "recordingprofile.h"
 #include "firewirechannel.h"
@@ -14,6 +15,7 @@ using namespace std;
 #include "iptvrecorder.h"
 #include "mpegrecorder.h"
 #include "recorderbase.h"
+#include "seekindexfile.h"
 #include "cetonchannel.h"
 #include "asirecorder.h"
 #include "dvbrecorder.h"
@@ -49,7 +51,8 @@ RecorderBase::RecorderBase(TVRec *rec)
       request_pause(false),     paused(false),
       request_recording(false), recording(false),
       nextRingBuffer(NULL),     nextRecording(NULL),
-      positionMapType(MARK_GOP_BYFRAME)
+      positionMapType(MARK_GOP_BYFRAME),
+      seekIndexInvalid(false)
 {
     ClearStatistics();
     QMutexLocker locker(avcodeclock);
@@ -427,15 +430,46 @@ void RecorderBase::SavePositionMap(bool force)
             // which is populating the delta map
             frm_pos_map_t deltaCopy(positionMapDelta);
             positionMapDelta.clear();
+            bool first_save = positionMap.size() <= delta_size;
             positionMapLock.unlock();
 
-            curRecording->SavePositionMapDelta(deltaCopy, positionMapType);
+            // keep the seek index next to the recording in step with
+            // the database, starting over with the file's first delta.
+            // Once a delta is missing from it the index stays removed,
+            // readers use the database for the rest of the recording.
+            QString path = curRecording->GetPathname();
+            if (!path.startsWith("myth://"))
+            {
+                if (first_save)
+                {
+                    SeekIndexFile::Remove(path);
+                    seekIndexInvalid = false;
+                }
+                if (!seekIndexInvalid &&
+                    !SeekIndexFile::Append(path, deltaCopy, positionMapType))
+                {
+                    seekIndexInvalid = true;
+                    SeekIndexFile::Remove(path);
+                }
+            }
+
+            // the writer thread does the inserts, so a busy database
+            // does not stall the recorder
+            PositionMapWriter::Enqueue(
+                curRecording->GetChanID(),
+                curRecording->GetRecordingStartTime(),
+                deltaCopy, positionMapType);
         }
         else
         {
             positionMapLock.unlock();
         }
 
+        // a forced save marks the end of a recording, make sure the
+        // position map is in the database before it is used
+        if (force)
+            PositionMapWriter::Flush();
+
         if (ringBuffer)
         {
             curRecording->SaveFilesize(ringBuffer->GetWritePosition());
@@ -302,6 +302,9 @@ class MTV_PUBLIC RecorderBase : public QRunnable
     frm_pos_map_t  positionMap;
     frm_pos_map_t  positionMapDelta;
     MythTimer      positionMapTimer;
+    /// Set when a delta could not be added to the seek index, see
+    /// SavePositionMap(). Only used by the thread saving the map.
+    bool           seekIndexInvalid;
 
     // Statistics
     // Note: Once we enter RecorderBase::run(), only that thread can
@@ -112,6 +112,7 @@ RecordingInfo::RecordingInfo(
     future(_future),
     desiredrecstartts(_startts),
     desiredrecendts(_endts),
+    mplexid(-1),
     record(NULL)
 {
     hostname = _hostname;
@@ -207,6 +208,7 @@ RecordingInfo::RecordingInfo(
     future(false),
     desiredrecstartts(_startts),
     desiredrecendts(_endts),
+    mplexid(-1),
     record(NULL)
 {
     recpriority = _recpriority;
@@ -240,6 +242,7 @@ RecordingInfo::RecordingInfo(
     future(false),
     desiredrecstartts(),
     desiredrecendts(),
+    mplexid(-1),
     record(NULL)
 {
     ProgramList schedList;
@@ -383,6 +386,8 @@ void RecordingInfo::clone(const RecordingInfo &other,
         record = NULL;
     }
 
+    mplexid = other.mplexid;
+
     if (!ignore_non_serialized_data)
     {
         oldrecstatus   = other.oldrecstatus;
@@ -416,6 +421,7 @@ void RecordingInfo::clone(const ProgramInfo &other,
     future         = false;
     desiredrecstartts = QDateTime();
     desiredrecendts = QDateTime();
+    mplexid        = -1;
 }
 
 void RecordingInfo::clear(void)
@@ -430,6 +436,7 @@ void RecordingInfo::clear(void)
     future = false;
     desiredrecstartts = QDateTime();
     desiredrecendts = QDateTime();
+    mplexid = -1;
 }
 
 
@@ -38,6 +38,7 @@ class MTV_PUBLIC RecordingInfo : public ProgramInfo
         future(false),
         desiredrecstartts(),
         desiredrecendts(),
+        mplexid(-1),
         record(NULL) {}
     RecordingInfo(const RecordingInfo &other) :
         ProgramInfo(other),
@@ -46,6 +47,7 @@ class MTV_PUBLIC RecordingInfo : public ProgramInfo
         future(other.future),
         desiredrecstartts(other.desiredrecstartts),
         desiredrecendts(other.desiredrecendts),
+        mplexid(other.mplexid),
         record(NULL) {}
     RecordingInfo(const ProgramInfo &other) :
         ProgramInfo(other),
@@ -54,6 +56,7 @@ class MTV_PUBLIC RecordingInfo : public ProgramInfo
         future(false),
         desiredrecstartts(startts),
         desiredrecendts(endts),
+        mplexid(-1),
         record(NULL) {}
     RecordingInfo(uint _chanid, const QDateTime &_recstartts) :
         ProgramInfo(_chanid, _recstartts),
@@ -62,6 +65,7 @@ class MTV_PUBLIC RecordingInfo : public ProgramInfo
         future(false),
         desiredrecstartts(startts),
         desiredrecendts(endts),
+        mplexid(-1),
         record(NULL) {}
     RecordingInfo(QStringList::const_iterator &it,
                   QStringList::const_iterator  end) :
@@ -71,6 +75,7 @@ class MTV_PUBLIC RecordingInfo : public ProgramInfo
         future(false),
         desiredrecstartts(startts),
         desiredrecendts(endts),
+        mplexid(-1),
         record(NULL) {}
     /// Create RecordingInfo from 'program'+'record'+'channel' tables,
     /// used in scheduler.cpp @ ~ 3296
@@ -225,6 +230,12 @@ class MTV_PUBLIC RecordingInfo : public ProgramInfo
     QDateTime GetDesiredStartTime(void) const { return desiredrecstartts; }
     QDateTime GetDesiredEndTime(void) const { return desiredrecendts; }
 
+    /// Multiplex this would be recorded on, the cached value set by
+    /// SetMplexID() if any, otherwise this queries the DB.
+    uint GetMplexID(void) const
+        { return (mplexid >= 0) ? (uint) mplexid : QueryMplexID(); }
+    void SetMplexID(uint _mplexid) { mplexid = _mplexid; }
+
     // these five can be moved to programinfo
     void AddHistory(bool resched = true, bool forcedup = false, 
                     bool future = false);//pi
@@ -254,6 +265,7 @@ class MTV_PUBLIC RecordingInfo : public ProgramInfo
     QDateTime desiredrecendts;
 
   private:
+    int mplexid; ///< cached multiplex id, -1 if not resolved
     mutable class RecordingRule *record;
 
   protected:
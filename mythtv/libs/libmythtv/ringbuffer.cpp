@@ -9,9 +9,14 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <fcntl.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <poll.h>
+#endif
 
 // Qt headers
 #include <QFile>
+#include <QFileInfo>
 #include <QDateTime>
 
 #include "ThreadedFileWriter.h"
@@ -1324,6 +1329,133 @@ int RingBuffer::Read(void *buf, int count)
     return ret;
 }
 
+/** \brief Sends data from the file straight to a socket, without copying
+ *         it through user space.
+ *
+ *   This is only possible for a local file opened for reading without
+ *   read-ahead, otherwise -1 is returned with errno set to ENOSYS and the
+ *   caller should use Read() instead. Like Read() the read position is
+ *   advanced by the number of bytes sent. Unlike Read() this does not wait
+ *   for a file that is still being recorded to grow, a short count means
+ *   the caller should use Read() for the rest.
+ *
+ *  \param sockfd Socket to send to, it may be non-blocking
+ *  \param count  Number of bytes to send
+ *  \return Returns number of bytes sent, or -1 on error
+ */
+int RingBuffer::SendFile(int sockfd, int count)
+{
+#ifdef __linux__
+    rwlock.lockForWrite();
+    poslock.lockForRead();
+    bool direct = (type == kRingBuffer_File) && !writemode && !remotefile &&
+        (fd2 >= 0) && !readaheadrunning && !request_pause &&
+        !commserror && (ignorereadpos < 0);
+    poslock.unlock();
+
+    if (!direct)
+    {
+        rwlock.unlock();
+        errno = ENOSYS;
+        return -1;
+    }
+
+    MythTimer timer;
+    timer.start();
+
+    int tot = 0;
+    int waited = 0;
+    while (tot < count && !stopreads)
+    {
+        ssize_t ret = sendfile(sockfd, fd2, NULL, count - tot);
+        if (ret > 0)
+        {
+            tot += ret;
+            waited = 0;
+        }
+        else if (ret == 0)
+        {
+            break; // EOF
+        }
+        else if (errno == EAGAIN || errno == EINTR)
+        {
+            // the socket is non-blocking, wait for room in its buffer
+            struct pollfd pfd;
+            pfd.fd      = sockfd;
+            pfd.events  = POLLOUT;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, 100) == 0 && (waited += 100) >= 5000)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    "SendFile(): Timed out waiting for the socket");
+                tot = -1;
+                break;
+            }
+        }
+        else
+        {
+            // EINVAL and ENOSYS mean sendfile() does not support this
+            // file, other errors are socket errors.
+            if (errno != EINVAL && errno != ENOSYS)
+                LOG(VB_GENERAL, LOG_ERR, LOC + "SendFile() failed" + ENO);
+            if (!tot)
+            {
+                int err = errno;
+                rwlock.unlock();
+                errno = (err == EINVAL) ? ENOSYS : err;
+                return -1;
+            }
+            break;
+        }
+    }
+
+    if (tot > 0)
+    {
+        int elapsed = timer.elapsed();
+        UpdateStorageRate(!elapsed ? 1000000001 :
+                          (uint64_t)(((float)tot * 8000.0) / (float)elapsed));
+
+        poslock.lockForWrite();
+        readpos += tot;
+        poslock.unlock();
+    }
+    rwlock.unlock();
+
+    if (tot > 0)
+        UpdateDecoderRate(tot);
+    return tot;
+#else
+    (void) sockfd;
+    (void) count;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/** \brief Returns true if SendFile() can work for this file.
+ *
+ *   That is a plain local file on Linux. SendFile() needs the file opened
+ *   without read-ahead, so callers that want to use it should only ask for
+ *   read-ahead when this returns false.
+ */
+bool RingBuffer::CanSendFile(const QString &filename)
+{
+#ifdef __linux__
+    QString lower = filename.toLower();
+    if (lower.startsWith("myth://") || lower.startsWith("http://") ||
+        lower.startsWith("https://") || lower.startsWith("dvd:") ||
+        lower.startsWith("bd:") ||
+        lower.endsWith(".img") || lower.endsWith(".iso"))
+    {
+        return false;
+    }
+    return QFileInfo(filename).isFile();
+#else
+    (void) filename;
+    return false;
+#endif
+}
+
 QString RingBuffer::BitrateToString(uint64_t rate, bool hz)
 {
     QString msg;
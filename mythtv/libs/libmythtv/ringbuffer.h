@@ -115,6 +115,8 @@ class MTV_PUBLIC RingBuffer : protected MThread
 
     int  Read(void *buf, int count);
     int  Peek(void *buf, int count); // only works with readahead
+    int  SendFile(int sockfd, int count);
+    static bool CanSendFile(const QString &filename);
 
     void Reset(bool full          = false,
                bool toAdjust      = false,
@@ -32,6 +32,7 @@
 #include "v4lchannel.h"
 #include "dialogbox.h"
 #include "jobqueue.h"
+#include "psicache.h"
 #include "mythdb.h"
 #include "tv_rec.h"
 #include "mythdate.h"
@@ -88,6 +89,7 @@ TVRec::TVRec(int capturecardnum)
       // Configuration variables from database
       transcodeFirst(false),
       earlyCommFlag(false),         runJobOnHostOnly(false),
+      fastChannelChange(false),
       eitCrawlIdleStart(60),        eitTransportTimeout(5*60),
       audioSampleRateDB(0),
       overRecordSecNrml(0),         overRecordSecCat(0),
@@ -106,6 +108,7 @@ TVRec::TVRec(int capturecardnum)
       triggerEventSleepSignal(false),
       switchingBuffer(false),
       m_recStatus(rsUnknown),
+      psiSeeded(false),             seededSDTWait(false),
       // Current recording info
       curRecording(NULL),
       overrecordseconds(0),
@@ -161,6 +164,7 @@ bool TVRec::Init(void)
         gCoreContext->GetNumSetting("AutoTranscodeBeforeAutoCommflag", 0);
     earlyCommFlag     = gCoreContext->GetNumSetting("AutoCommflagWhileRecording", 0);
     runJobOnHostOnly  = gCoreContext->GetNumSetting("JobsRunOnRecordHost", 0);
+    fastChannelChange = gCoreContext->GetNumSetting("FastChannelChange", 0);
     eitTransportTimeout =
         max(gCoreContext->GetNumSetting("EITTransportTimeout", 5) * 60, 6);
     eitCrawlIdleStart = gCoreContext->GetNumSetting("EITCrawIdleStart", 60);
@@ -1965,7 +1969,7 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
     return ok;
 }
 
-/** \fn TVRec::SetupSignalMonitor(bool,bool)
+/** \fn TVRec::SetupSignalMonitor(bool,bool,bool,bool)
  *  \brief This creates a SignalMonitor instance and
  *         begins signal monitoring.
  *
@@ -1975,9 +1979,12 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
  *
  *  \param tablemon If set we enable table monitoring
  *  \param notify   If set we notify the frontend of the signal values
+ *  \param seed_psi If set we seed the table monitor with the cached
+ *                  PAT and PMT, see SeedCachedPSI()
  *  \return true on success, false on failure
  */
-bool TVRec::SetupSignalMonitor(bool tablemon, bool EITscan, bool notify)
+bool TVRec::SetupSignalMonitor(bool tablemon, bool EITscan, bool notify,
+                               bool seed_psi)
 {
     LOG(VB_RECORD, LOG_INFO, LOC + QString("SetupSignalMonitor(%1, %2)")
             .arg(tablemon).arg(notify));
@@ -2013,6 +2020,11 @@ bool TVRec::SetupSignalMonitor(bool tablemon, bool EITscan, bool notify)
             return false;
         }
 
+        psiSeeded     = false;
+        seededSDTWait = false;
+        if (GetDTVSignalMonitor() && tablemon && !EITscan && seed_psi)
+            SeedCachedPSI();
+
         signalMonitor->AddListener(this);
         signalMonitor->SetUpdateRate(signalMonitor->HasExtraSlowTuning() ?
                                      kSignalMonitoringRate * 5 :
@@ -2026,6 +2038,111 @@ bool TVRec::SetupSignalMonitor(bool tablemon, bool EITscan, bool notify)
     return true;
 }
 
+/** \brief Seeds the DTV signal monitor with the PAT and PMT cached the
+ *         last time this channel was tuned.
+ *
+ *   With the tables matched up front the signal monitor only has to
+ *   wait for a signal lock, so the recorder starts on the cached PMT.
+ *   MPEGStreamData checks the live tables against the seeded ones once
+ *   they arrive and switches to the live ones if they differ.
+ */
+void TVRec::SeedCachedPSI(void)
+{
+    DTVSignalMonitor *sm = GetDTVSignalMonitor();
+    MPEGStreamData   *sd = sm->GetStreamData();
+    int progNum = sm->GetProgramNumber();
+
+    // ATSC channels still need the VCT, so seeding does not help there
+    if (!sd || progNum < 0 ||
+        sm->HasFlags(SignalMonitor::kDTVSigMon_WaitForVCT))
+    {
+        return;
+    }
+
+    uint mplexid = ChannelUtil::GetMplexID(
+        channel->GetCurrentSourceID(), channel->GetCurrentName());
+
+    QByteArray pat_data, pmt_data;
+    if (!PSICache::Lookup(mplexid, progNum, pat_data, pmt_data))
+    {
+        LOG(VB_CHANNEL, LOG_INFO, LOC +
+            QString("No cached PAT/PMT for program %1").arg(progNum));
+        return;
+    }
+
+    const ProgramAssociationTable pat(PSIPTable(PESPacket::ViewData(
+        reinterpret_cast<const unsigned char*>(pat_data.constData()))));
+    const ProgramMapTable pmt(PSIPTable(PESPacket::ViewData(
+        reinterpret_cast<const unsigned char*>(pmt_data.constData()))));
+
+    uint pmt_pid = pat.FindPID(progNum);
+    if (!pat.IsGood() || !pmt.IsGood() || !pmt_pid ||
+        pmt.ProgramNumber() != (uint)progNum)
+    {
+        LOG(VB_CHANNEL, LOG_WARNING, LOC +
+            QString("Cached PAT/PMT for program %1 is unusable")
+            .arg(progNum));
+        return;
+    }
+
+    sd->SeedTable(mplexid, MPEG_PAT_PID, pat);
+    sd->SeedTable(mplexid, pmt_pid, pmt);
+    psiSeeded = true;
+
+    // The SDT only confirms we are on the right transport, which the
+    // live PAT will do as well. Until that arrives the seeded PAT proves
+    // nothing, so StatusSignalLock() only drops the SDT wait afterwards.
+    seededSDTWait = sm->HasFlags(SignalMonitor::kDTVSigMon_WaitForSDT);
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC +
+        QString("Seeded cached PAT/PMT for program %1 on multiplex %2")
+        .arg(progNum).arg(mplexid));
+    TuningPhaseDone("cached PAT/PMT");
+}
+
+/** \brief Saves the DTV signal monitor's PAT and PMT in the PSICache,
+ *         for SeedCachedPSI() to use the next time this channel is tuned.
+ *
+ *   When the tables were seeded they may not have been seen live yet,
+ *   MPEGStreamData updates the PSICache itself if the live ones differ.
+ */
+void TVRec::SaveCachedPSI(void)
+{
+    if (psiSeeded)
+        return;
+
+    DTVSignalMonitor *sm = GetDTVSignalMonitor();
+    MPEGStreamData   *sd = sm ? sm->GetStreamData() : NULL;
+    int progNum = sm ? sm->GetProgramNumber() : -1;
+
+    if (!sd || progNum < 0 ||
+        sm->HasFlags(SignalMonitor::kDTVSigMon_WaitForVCT))
+    {
+        return;
+    }
+
+    pmt_const_ptr_t pmt  = sd->GetCachedPMT(progNum, 0);
+    pat_vec_t       pats = sd->GetCachedPATs();
+
+    const ProgramAssociationTable *pat = NULL;
+    for (uint i = 0; i < pats.size() && !pat; i++)
+    {
+        if (pats[i]->FindPID(progNum))
+            pat = pats[i];
+    }
+
+    if (pat && pmt)
+    {
+        uint mplexid = ChannelUtil::GetMplexID(
+            channel->GetCurrentSourceID(), channel->GetCurrentName());
+        PSICache::Store(mplexid, progNum, *pat, *pmt);
+    }
+
+    sd->ReturnCachedPATTables(pats);
+    if (pmt)
+        sd->ReturnCachedTable(pmt);
+}
+
 /** \fn TVRec::TeardownSignalMonitor()
  *  \brief If a SignalMonitor instance exists, the monitoring thread is
  *         stopped and the instance is deleted.
@@ -3687,6 +3804,12 @@ void TVRec::TuningShutdowns(const TuningRequest &request)
  */
 void TVRec::TuningFrequency(const TuningRequest &request)
 {
+    tuningTimerLock.lock();
+    tuningTimer.start();
+    tuningPhases.clear();
+    tuningTimings.clear();
+    tuningTimerLock.unlock();
+
     DTVChannel *dtvchan = GetDTVChannel();
     if (dtvchan)
     {
@@ -3726,6 +3849,7 @@ void TVRec::TuningFrequency(const TuningRequest &request)
         MythEvent me(QString("SIGNAL %1").arg(cardid), slist);
         gCoreContext->dispatch(me);
 
+        TuningPhaseDone("tune");
         SetFlags(kFlagNeedToStartRecorder);
         return;
     }
@@ -3769,6 +3893,7 @@ void TVRec::TuningFrequency(const TuningRequest &request)
                 QString("Failed to set channel to %1.").arg(channum));
         }
     }
+    TuningPhaseDone("tune");
 
     bool livetv = request.flags & kFlagLiveTV;
     bool antadj = request.flags & kFlagAntennaAdjust;
@@ -3808,7 +3933,8 @@ void TVRec::TuningFrequency(const TuningRequest &request)
         LOG(VB_RECORD, LOG_INFO, LOC + "Starting Signal Monitor");
         bool error = false;
         if (!SetupSignalMonitor(
-                !antadj, request.flags & kFlagEITScan, livetv | antadj))
+                !antadj, request.flags & kFlagEITScan, livetv | antadj,
+                livetv && fastChannelChange))
         {
             LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to setup signal monitor");
             if (signalMonitor)
@@ -3863,6 +3989,54 @@ void TVRec::TuningFrequency(const TuningRequest &request)
         SetFlags(kFlagNeedToStartRecorder);
 }
 
+/** \brief Notes how long after the start of the current channel change
+ *         a phase was first reached.
+ *
+ *   The phases are logged together once the last one, normally the
+ *   recorder's first keyframe, is reached. This is thread-safe.
+ */
+void TVRec::TuningPhaseDone(const QString &phase, bool last)
+{
+    QMutexLocker locker(&tuningTimerLock);
+    if (!tuningTimer.isRunning() || tuningPhases.contains(phase))
+        return;
+
+    int ms = tuningTimer.elapsed();
+    tuningPhases.push_back(phase);
+    tuningTimings.push_back(QString("%1 %2 ms").arg(phase).arg(ms));
+
+    if (last)
+    {
+        tuningTimer.stop();
+        LOG(VB_CHANNEL, LOG_INFO, LOC + "Channel change timings: " +
+            tuningTimings.join(", "));
+    }
+}
+
+/// Records the signal lock, PAT and PMT channel change phases, and drops
+/// the SDT wait of a seeded channel change once the live PAT arrived.
+/// Called from the signal monitor thread on each update.
+void TVRec::StatusSignalLock(const SignalMonitorValue &val)
+{
+    if (val.IsGood())
+        TuningPhaseDone("lock");
+
+    DTVSignalMonitor *dtvMon = GetDTVSignalMonitor();
+    if (seededSDTWait && dtvMon && dtvMon->GetStreamData() &&
+        !dtvMon->GetStreamData()->HasSeededTable(TableID::PAT))
+    {
+        seededSDTWait = false;
+        dtvMon->RemoveFlags(SignalMonitor::kDTVSigMon_WaitForSDT);
+        LOG(VB_CHANNEL, LOG_INFO, LOC +
+            "Live PAT seen, no longer waiting for the SDT");
+    }
+
+    if (dtvMon && dtvMon->HasFlags(SignalMonitor::kDTVSigMon_PATMatch))
+        TuningPhaseDone("PAT");
+    if (dtvMon && dtvMon->HasFlags(SignalMonitor::kDTVSigMon_PMTMatch))
+        TuningPhaseDone("PMT");
+}
+
 /** \fn TVRec::TuningSignalCheck(void)
  *  \brief This checks if we have a channel lock.
  *
@@ -3914,6 +4088,9 @@ MPEGStreamData *TVRec::TuningSignalCheck(void)
     if (GetDTVSignalMonitor())
         streamData = GetDTVSignalMonitor()->GetStreamData();
 
+    if (fastChannelChange && rsRecording == newRecStatus)
+        SaveCachedPSI();
+
     if (!HasFlags(kFlagEITScannerRunning))
     {
         // shut down signal monitoring
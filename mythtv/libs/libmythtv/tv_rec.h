@@ -17,6 +17,7 @@
 #include "recordinginfo.h"
 #include "tv.h"
 #include "signalmonitorlistener.h"
+#include "mythtimer.h"
 
 #include "mythconfig.h"
 #include "dvbchannel.h"
@@ -229,6 +230,7 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
 
     void RingBufferChanged(RingBuffer*, RecordingInfo*, RecordingQuality*);
     void RecorderPaused(void);
+    void TuningPhaseDone(const QString &phase, bool last = false);
 
     void SetNextLiveTVDir(QString dir);
 
@@ -238,7 +240,7 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
 
     virtual void AllGood(void) { WakeEventLoop(); }
     virtual void StatusChannelTuned(const SignalMonitorValue&) { }
-    virtual void StatusSignalLock(const SignalMonitorValue&) { }
+    virtual void StatusSignalLock(const SignalMonitorValue&);
     virtual void StatusSignalStrength(const SignalMonitorValue&) { }
 
   protected:
@@ -268,8 +270,11 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     V4LChannel *GetV4LChannel(void);
 
     bool SetupSignalMonitor(
-        bool enable_table_monitoring, bool EITscan, bool notify);
+        bool enable_table_monitoring, bool EITscan, bool notify,
+        bool seed_psi = false);
     bool SetupDTVSignalMonitor(bool EITscan);
+    void SeedCachedPSI(void);
+    void SaveCachedPSI(void);
     void TeardownSignalMonitor(void);
     DTVSignalMonitor *GetDTVSignalMonitor(void);
 
@@ -337,6 +342,7 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     bool    transcodeFirst;
     bool    earlyCommFlag;
     bool    runJobOnHostOnly;
+    bool    fastChannelChange;
     int     eitCrawlIdleStart;
     int     eitTransportTimeout;
     int     audioSampleRateDB;
@@ -375,6 +381,16 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     volatile bool  switchingBuffer;
     RecStatusType  m_recStatus;
 
+    // Cached PSI, see SeedCachedPSI()
+    bool           psiSeeded;      ///< PAT/PMT seeded from the PSICache
+    volatile bool  seededSDTWait;  ///< SDT wait to drop on the live PAT
+
+    // Channel change timings
+    QMutex         tuningTimerLock;
+    MythTimer      tuningTimer;    ///< started by TuningFrequency()
+    QStringList    tuningPhases;   ///< phases reached, protected by lock
+    QStringList    tuningTimings;  ///< "phase N ms", protected by lock
+
     // Current recording info
     RecordingInfo *curRecording;
     QDateTime    recordEndTime;
@@ -27,6 +27,12 @@ void MythBackendCommandLineParser::LoadArguments(void)
          << add("--testsched", "testsched", false,
                 "do some scheduler testing.", "")
 //                    ->SetDeprecated("use mythutil instead")
+         << add("--benchsched", "benchsched", 20000U,
+                "Time the scheduler placement pass on a synthetic schedule.",
+                "Builds a synthetic schedule with the given number of "
+                "pending recordings spread over eight inputs and two weeks, "
+                "runs the scheduler placement pass on it and prints how "
+                "long that took. The recording tables are not touched.")
          << add("--resched", "resched", false,
                 "Trigger a run of the recording scheduler on the existing "
                 "master backend.",
@@ -1,3 +1,6 @@
+// ANSI C headers
+#include <cerrno>
+
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QFileInfo>
@@ -13,9 +16,14 @@ FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
                            bool usereadahead, int timeout_ms) :
     ReferenceCounter(QString("FileTransfer:%1").arg(filename)),
     readthreadlive(true), readsLocked(false),
-    rbuffer(RingBuffer::Create(filename, false, usereadahead, timeout_ms, true)),
+    // sendfile() needs the file without our read-ahead, the kernel's
+    // page cache read-ahead takes its place
+    rbuffer(RingBuffer::Create(
+                filename, false,
+                usereadahead && !RingBuffer::CanSendFile(filename),
+                timeout_ms, true)),
     sock(remote), ateof(false), lock(QMutex::NonRecursive),
-    writemode(false)
+    writemode(false), usesendfile(true)
 {
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
@@ -27,7 +35,7 @@ FileTransfer::FileTransfer(QString &filename, MythSocket *remote, bool write) :
     readthreadlive(true), readsLocked(false),
     rbuffer(RingBuffer::Create(filename, write)),
     sock(remote), ateof(false), lock(QMutex::NonRecursive),
-    writemode(write)
+    writemode(write), usesendfile(!write)
 {
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
@@ -129,10 +137,36 @@ int FileTransfer::RequestBlock(int size)
 
     requestBuffer.resize(max((size_t)max(size,0) + 128, requestBuffer.size()));
     char *buf = &requestBuffer[0];
+    bool direct = usesendfile;
     while (tot < size && !rbuffer->GetStopReads() && readthreadlive)
     {
         int request = size - tot;
 
+        if (direct)
+        {
+            ret = rbuffer->SendFile(sock->socket(), request);
+            if (ret < 0 && errno == ENOSYS)
+            {
+                LOG(VB_FILE, LOG_INFO, "RequestBlock: sendfile() is not "
+                    "usable for this file, copying the data instead");
+                usesendfile = direct = false;
+                ret = 0;
+                continue;
+            }
+            if (ret < 0)
+            {
+                tot = -1;
+                break;
+            }
+
+            tot += ret;
+            // A short count means we reached the end of the file, which
+            // may still be recording; Read() waits for it to grow.
+            if (ret < request)
+                direct = false;
+            continue;
+        }
+
         ret = rbuffer->Read(buf, request);
         
         if (rbuffer->GetStopReads() || ret <= 0)
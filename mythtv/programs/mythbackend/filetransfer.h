@@ -64,6 +64,7 @@ class FileTransfer : public ReferenceCounter
     QMutex lock;
 
     bool writemode;
+    bool usesendfile; ///< false once sendfile() failed for this file
 };
 
 #endif
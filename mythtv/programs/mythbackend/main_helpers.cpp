@@ -24,6 +24,7 @@
 #include <QMap>
 
 #include "tv_rec.h"
+#include "positionmapwriter.h"
 #include "scheduledrecording.h"
 #include "mythsocketthread.h"
 #include "autoexpire.h"
@@ -258,6 +259,8 @@ void cleanup(void)
         delete rec;
     }
 
+    PositionMapWriter::Shutdown();
+
     delete gContext;
     gContext = NULL;
 
@@ -378,6 +381,14 @@ int handle_command(const MythBackendCommandLineParser &cmdline)
         return GENERIC_EXIT_OK;
     }
 
+    if (cmdline.toBool("benchsched"))
+    {
+        Scheduler *sched = new Scheduler(false, &tvList);
+        sched->BenchmarkPlacement(cmdline.toUInt("benchsched"));
+        delete sched;
+        return GENERIC_EXIT_OK;
+    }
+
     if (cmdline.toBool("resched"))
     {
         bool ok = false;
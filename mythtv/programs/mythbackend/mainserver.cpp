@@ -51,6 +51,7 @@ using namespace std;
 #include "scheduler.h"
 #include "backendutil.h"
 #include "programinfo.h"
+#include "seekindexfile.h"
 #include "mythtimezone.h"
 #include "recordinginfo.h"
 #include "recordingrule.h"
@@ -2036,6 +2037,12 @@ void MainServer::DoDeleteThread(DeleteStruct *ds)
         delete_file_immediately( sFileName, followLinks, true);
     }
 
+    /* Delete the seek index. */
+
+    QString seekIndex = SeekIndexFile::GetFilename(ds->m_filename);
+    if (QFile::exists(seekIndex))
+        delete_file_immediately(seekIndex, followLinks, true);
+
     DeleteRecordedFiles(ds);
 
     DoDeleteInDB(ds);
@@ -225,6 +225,9 @@ bool Scheduler::VerifyCards(void)
     return true;
 }
 
+/// Longest time HandleReschedule() goes without a full placement pass.
+static const int kMaxSecsBetweenPlacements = 60 * 60;
+
 static inline bool Recording(const RecordingInfo *p)
 {
     return (p->GetRecordingStatus() == rsRecording ||
@@ -357,34 +360,57 @@ static bool comp_priority(RecordingInfo *a, RecordingInfo *b)
     return a->GetRecordingRuleID() < b->GetRecordingRuleID();
 }
 
+/// Appends the time since \a start to \a times and restarts \a start.
+static void add_phase_time(QStringList &times, const char *phase,
+                           struct timeval &start)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    float secs = ((now.tv_sec - start.tv_sec ) * 1000000 +
+                  (now.tv_usec - start.tv_usec)) / 1000000.0;
+    times << QString("%1 %2").arg(phase).arg(secs, 0, 'f', 2);
+    start = now;
+}
+
 bool Scheduler::FillRecordList(void)
 {
+    struct timeval phasestart;
+    QStringList phasetimes;
+
     schedMoveHigher = (bool)gCoreContext->GetNumSetting("SchedMoveHigher");
     schedTime = MythDate::current();
 
+    gettimeofday(&phasestart, NULL);
     LOG(VB_SCHEDULE, LOG_INFO, "BuildWorkList...");
     BuildWorkList();
+    add_phase_time(phasetimes, "BuildWorkList", phasestart);
 
     schedLock.unlock();
 
     LOG(VB_SCHEDULE, LOG_INFO, "AddNewRecords...");
     AddNewRecords();
+    add_phase_time(phasetimes, "AddNewRecords", phasestart);
     LOG(VB_SCHEDULE, LOG_INFO, "AddNotListed...");
     AddNotListed();
+    add_phase_time(phasetimes, "AddNotListed", phasestart);
 
     LOG(VB_SCHEDULE, LOG_INFO, "Sort by time...");
     SORT_RECLIST(worklist, comp_overlap);
     LOG(VB_SCHEDULE, LOG_INFO, "PruneOverlaps...");
     PruneOverlaps();
+    add_phase_time(phasetimes, "PruneOverlaps", phasestart);
 
     LOG(VB_SCHEDULE, LOG_INFO, "Sort by priority...");
     SORT_RECLIST(worklist, comp_priority);
     LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
     BuildListMaps();
+    add_phase_time(phasetimes, "BuildListMaps", phasestart);
     LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
     SchedNewRecords();
+    add_phase_time(phasetimes, "SchedNewRecords", phasestart);
     LOG(VB_SCHEDULE, LOG_INFO, "SchedPreserveLiveTV...");
     SchedPreserveLiveTV();
+    add_phase_time(phasetimes, "SchedPreserveLiveTV", phasestart);
     LOG(VB_SCHEDULE, LOG_INFO, "ClearListMaps...");
     ClearListMaps();
 
@@ -394,11 +420,16 @@ bool Scheduler::FillRecordList(void)
     SORT_RECLIST(worklist, comp_redundant);
     LOG(VB_SCHEDULE, LOG_INFO, "PruneRedundants...");
     PruneRedundants();
+    add_phase_time(phasetimes, "PruneRedundants", phasestart);
 
     LOG(VB_SCHEDULE, LOG_INFO, "Sort by time...");
     SORT_RECLIST(worklist, comp_recstart);
     LOG(VB_SCHEDULE, LOG_INFO, "ClearWorkList...");
     bool res = ClearWorkList();
+    add_phase_time(phasetimes, "ClearWorkList", phasestart);
+
+    LOG(VB_SCHEDULE, LOG_INFO,
+        "Place time by phase: " + phasetimes.join(", "));
 
     return res;
 }
@@ -569,6 +600,77 @@ void Scheduler::PrintRec(const RecordingInfo *p, const char *prefix)
     LOG(VB_SCHEDULE, LOG_INFO, outstr);
 }
 
+/** \brief Times the placement pass on a synthetic schedule.
+ *
+ *  Builds \a count pending recordings for 500 rules spread over eight
+ *  inputs and the next two weeks, runs them through SchedNewRecords()
+ *  and prints the time it took. Nothing is read from or written to the
+ *  recording tables, so this can be run against a live database.
+ */
+void Scheduler::BenchmarkPlacement(uint count)
+{
+    static const uint kInputs = 8;
+    static const uint kRules  = 500;
+
+    schedTime = MythDate::current();
+    QDateTime base = schedTime.addSecs(3600 - schedTime.toTime_t() % 3600);
+
+    srandom(count);
+    for (uint i = 0; i < count; i++)
+    {
+        uint rule  = 1 + random() % kRules;
+        uint input = 1 + random() % kInputs;
+        QDateTime start = base.addSecs((random() % (14 * 48)) * 1800);
+        QDateTime end   = start.addSecs((1 + random() % 2) * 1800);
+
+        RecordingInfo *p = new RecordingInfo();
+        p->SetTitle(QString("Rule %1").arg(rule));
+        p->SetProgramID(QString("EP%1%2")
+                        .arg(rule, 6, 10, QChar('0'))
+                        .arg(random() % 20, 4, 10, QChar('0')));
+        p->SetChanID(1000 + random() % 100);
+        p->SetSourceID(1);
+        p->SetCardID(input);
+        p->SetInputID(input);
+        p->SetMplexID(0);
+        p->SetScheduledStartTime(start);
+        p->SetScheduledEndTime(end);
+        p->SetRecordingStartTime(start);
+        p->SetRecordingEndTime(end);
+        p->SetRecordingRuleID(rule);
+        p->SetRecordingRuleType(kAllRecord);
+        p->SetRecordingPriority(random() % 5);
+        p->SetRecordingStatus(rsUnknown);
+        worklist.push_back(p);
+    }
+
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    SORT_RECLIST(worklist, comp_priority);
+    BuildListMaps();
+    SchedNewRecords();
+    ClearListMaps();
+
+    gettimeofday(&end, NULL);
+    float placeTime = ((end.tv_sec - start.tv_sec ) * 1000000 +
+                       (end.tv_usec - start.tv_usec)) / 1000000.0;
+
+    uint willrecord = 0;
+    while (!worklist.empty())
+    {
+        RecordingInfo *p = worklist.front();
+        willrecord += (p->GetRecordingStatus() == rsWillRecord) ? 1 : 0;
+        delete p;
+        worklist.pop_front();
+    }
+
+    QString msg;
+    msg.sprintf("Placed %u recordings on %u inputs in %.3f seconds, "
+                "%u will record", count, kInputs, placeTime, willrecord);
+    cout << msg.toLocal8Bit().constData() << endl;
+}
+
 void Scheduler::UpdateRecStatus(RecordingInfo *pginfo)
 {
     QMutexLocker lockit(&schedLock);
@@ -835,6 +937,8 @@ void Scheduler::SlaveDisconnected(uint cardid)
 
 void Scheduler::BuildWorkList(void)
 {
+    LoadMplexIDs();
+
     RecIter i = reclist.begin();
     for (; i != reclist.end(); ++i)
     {
@@ -843,6 +947,48 @@ void Scheduler::BuildWorkList(void)
             p->GetRecordingStatus() == rsTuning)
             worklist.push_back(new RecordingInfo(*p));
     }
+
+    SetMplexIDs(worklist);
+}
+
+/** \brief Loads the multiplex of every channel in one query.
+ *
+ *  FindNextConflict() compares the multiplexes of all recordings on
+ *  shared input groups, doing that with ProgramInfo::QueryMplexID()
+ *  means two queries per comparison.
+ */
+void Scheduler::LoadMplexIDs(void)
+{
+    mplexidmap.clear();
+
+    MSqlQuery query(dbConn);
+    query.prepare("SELECT chanid, mplexid FROM channel");
+
+    if (!query.exec())
+    {
+        MythDB::DBError("LoadMplexIDs", query);
+        return;
+    }
+
+    while (query.next())
+    {
+        uint mplexid = query.value(1).toUInt();
+        // clear out bogus mplexid's
+        mplexidmap[query.value(0).toUInt()] = (32767 == mplexid) ? 0 : mplexid;
+    }
+}
+
+/// Stores the multiplex loaded by LoadMplexIDs() on each recording.
+void Scheduler::SetMplexIDs(RecList &list) const
+{
+    RecIter i = list.begin();
+    for (; i != list.end(); ++i)
+    {
+        QMap<uint, uint>::const_iterator it =
+            mplexidmap.find((*i)->GetChanID());
+        if (it != mplexidmap.end())
+            (*i)->SetMplexID(*it);
+    }
 }
 
 bool Scheduler::ClearWorkList(void)
@@ -919,6 +1065,9 @@ void Scheduler::PruneOverlaps(void)
 
 void Scheduler::BuildListMaps(void)
 {
+    // pick up the recordings added by AddNewRecords() and AddNotListed()
+    SetMplexIDs(worklist);
+
     RecIter i = worklist.begin();
     for ( ; i != worklist.end(); ++i)
     {
@@ -933,11 +1082,14 @@ void Scheduler::BuildListMaps(void)
             recordidlistmap[p->GetRecordingRuleID()].push_back(p);
         }
     }
+
+    conflictindex.Build(conflictlist);
 }
 
 void Scheduler::ClearListMaps(void)
 {
     conflictlist.clear();
+    conflictindex.Clear();
     titlelistmap.clear();
     recordidlistmap.clear();
     cache_is_same_program.clear();
@@ -1017,15 +1169,15 @@ bool Scheduler::FindNextConflict(
                      .arg(p->GetCardID()).arg(q->GetCardID())
                      .arg(igrp.GetSharedInputGroup(
                               p->GetInputID(), q->GetInputID()))
-                     .arg(p->QueryMplexID()).arg(q->QueryMplexID()));
+                     .arg(p->GetMplexID()).arg(q->GetMplexID()));
         }
 
         // if two inputs are in the same input group we have a conflict
         // unless the programs are on the same multiplex.
         if (p->GetCardID() != q->GetCardID())
         {
-            uint p_mplexid = p->QueryMplexID();
-            if (p_mplexid && (p_mplexid == q->QueryMplexID()))
+            uint p_mplexid = p->GetMplexID();
+            if (p_mplexid && (p_mplexid == q->GetMplexID()))
                 continue;
         }
 
@@ -1045,13 +1197,94 @@ const RecordingInfo *Scheduler::FindConflict(
     const RecordingInfo        *p,
     int openend) const
 {
-    RecConstIter k = conflictlist.begin();
-    if (FindNextConflict(conflictlist, p, k, openend))
+    RecList candidates;
+    GetConflictCandidates(p, candidates);
+
+    RecConstIter k = candidates.begin();
+    if (FindNextConflict(candidates, p, k, openend))
         return *k;
 
     return NULL;
 }
 
+/** \brief Returns the entries of conflictlist that may conflict with \a p,
+ *         in conflictlist order.
+ */
+void Scheduler::GetConflictCandidates(
+    const RecordingInfo *p, RecList &list) const
+{
+    conflictindex.GetCandidates(p, list);
+}
+
+/// Width of the RecListTimeIndex buckets in seconds.
+static const uint kTimeIndexBucketSecs = 3600;
+/// Entries spanning more buckets than this are checked for every query.
+static const uint kTimeIndexMaxBuckets = 14 * 24;
+
+uint RecListTimeIndex::Bucket(const QDateTime &dt)
+{
+    return dt.toTime_t() / kTimeIndexBucketSecs;
+}
+
+void RecListTimeIndex::Build(const RecList &list)
+{
+    Clear();
+
+    items.reserve(list.size());
+    RecConstIter it = list.begin();
+    for (uint i = 0; it != list.end(); ++it, ++i)
+    {
+        RecordingInfo *p = *it;
+        items.push_back(p);
+
+        uint first = Bucket(p->GetRecordingStartTime());
+        uint last  = Bucket(p->GetRecordingEndTime());
+        if (last < first || last - first > kTimeIndexMaxBuckets)
+        {
+            unbounded.push_back(i);
+            continue;
+        }
+
+        // the end points are included since FindNextConflict() treats
+        // touching recordings as overlapping in some openEnd modes.
+        for (uint b = first; b <= last; b++)
+            buckets[b].push_back(i);
+    }
+}
+
+void RecListTimeIndex::Clear(void)
+{
+    items.clear();
+    buckets.clear();
+    unbounded.clear();
+}
+
+void RecListTimeIndex::GetCandidates(
+    const RecordingInfo *p, RecList &candidates) const
+{
+    uint first = Bucket(p->GetRecordingStartTime());
+    uint last  = Bucket(p->GetRecordingEndTime());
+    if (last < first || last - first > kTimeIndexMaxBuckets)
+    {
+        candidates.insert(candidates.end(), items.begin(), items.end());
+        return;
+    }
+
+    vector<uint> idx(unbounded);
+    for (uint b = first; b <= last; b++)
+    {
+        QHash<uint, vector<uint> >::const_iterator it = buckets.find(b);
+        if (it != buckets.end())
+            idx.insert(idx.end(), it->begin(), it->end());
+    }
+
+    sort(idx.begin(), idx.end());
+    idx.erase(unique(idx.begin(), idx.end()), idx.end());
+
+    for (uint i = 0; i < idx.size(); i++)
+        candidates.push_back(items[idx[i]]);
+}
+
 void Scheduler::MarkOtherShowings(RecordingInfo *p)
 {
     RecList *showinglist;
@@ -1324,8 +1557,10 @@ void Scheduler::MoveHigherRecords(bool move_this)
         p->SetRecordingStatus(rsWillRecord);
         MarkOtherShowings(p);
 
-        RecConstIter k = conflictlist.begin();
-        for ( ; FindNextConflict(conflictlist, p, k); ++k)
+        RecList candidates;
+        GetConflictCandidates(p, candidates);
+        RecConstIter k = candidates.begin();
+        for ( ; FindNextConflict(candidates, p, k); ++k)
         {
             if (!TryAnotherShowing(*k, true))
             {
@@ -1359,8 +1594,10 @@ void Scheduler::MoveHigherRecords(bool move_this)
         if (move_this)
             MarkOtherShowings(p);
 
-        RecConstIter k = conflictlist.begin();
-        for ( ; FindNextConflict(conflictlist, p, k); ++k)
+        RecList candidates;
+        GetConflictCandidates(p, candidates);
+        RecConstIter k = candidates.begin();
+        for ( ; FindNextConflict(candidates, p, k); ++k)
         {
             if ((p->GetRecordingPriority() < (*k)->GetRecordingPriority() &&
                  !schedMoveHigher && move_this) ||
@@ -2111,6 +2348,7 @@ bool Scheduler::HandleReschedule(void)
     QString msg;
     bool deleteFuture = false;
     bool runCheck = false;
+    bool runPlace = false;
     
     while (HaveQueuedRequests())
     {
@@ -2142,13 +2380,43 @@ bool Scheduler::HandleReschedule(void)
             uint sourceid = tokens[2].toUInt();
             uint mplexid = tokens[3].toUInt();
             QDateTime maxstarttime = MythDate::fromString(tokens[4]);
-            deleteFuture = true;
-            runCheck = true;
+            bool scoped = !recordid && (sourceid || mplexid);
+            QString scope = QString("%1 %2 %3").arg(sourceid).arg(mplexid)
+                .arg(tokens[4]);
+            QString fingerprint;
             schedLock.unlock();
             recordmatchLock.lock();
             UpdateMatches(recordid, sourceid, mplexid, maxstarttime);
+            if (scoped)
+                fingerprint = GetMatchFingerprint(sourceid, mplexid,
+                                                  maxstarttime);
             recordmatchLock.unlock();
             schedLock.lock();
+
+            // The rematched rows still need their duplicate checks.
+            deleteFuture = true;
+            runCheck = true;
+
+            // A source or multiplex scoped match, as sent after EIT
+            // updates, often finds exactly what was scheduled last time.
+            if (scoped && !fingerprint.isEmpty() &&
+                matchFingerprints.value(scope) == fingerprint)
+            {
+                LOG(VB_SCHEDULE, LOG_INFO,
+                    QString("No matches changed for sourceid %1 mplexid %2")
+                        .arg(sourceid).arg(mplexid));
+                continue;
+            }
+
+            // Forget the fingerprints this match may have changed
+            if (scoped)
+                ForgetMatchFingerprints(sourceid, mplexid);
+            else
+                matchFingerprints.clear();
+            if (scoped && !fingerprint.isEmpty())
+                matchFingerprints[scope] = fingerprint;
+
+            runPlace = true;
         }
         else if (tokens[0] == "CHECK")
         {
@@ -2167,6 +2435,8 @@ bool Scheduler::HandleReschedule(void)
             QString descrip = request[3];
             QString programid = request[4];
             runCheck = true;
+            runPlace = true;
+            matchFingerprints.clear();
             schedLock.unlock();
             recordmatchLock.lock();
             ResetDuplicates(recordid, findid, title, subtitle, descrip, 
@@ -2174,7 +2444,11 @@ bool Scheduler::HandleReschedule(void)
             recordmatchLock.unlock();
             schedLock.lock();
         }
-        else if (tokens[0] != "PLACE")
+        else if (tokens[0] == "PLACE")
+        {
+            runPlace = true;
+        }
+        else
         {
             LOG(VB_GENERAL, LOG_ERR, 
                 QString("Unknown Reschedule request received (%1)")
@@ -2214,6 +2488,20 @@ bool Scheduler::HandleReschedule(void)
     checkTime = ((fillend.tv_sec - fillstart.tv_sec ) * 1000000 +
                  (fillend.tv_usec - fillstart.tv_usec)) / 1000000.0;
 
+    // Nothing the requests did changes the schedule, but do a full
+    // placement pass now and then anyway as a consistency check.
+    if (!runPlace && lastPlaceTime.isValid() &&
+        lastPlaceTime.secsTo(MythDate::current()) < kMaxSecsBetweenPlacements)
+    {
+        LOG(VB_SCHEDULE, LOG_INFO, "DeleteTempTables...");
+        DeleteTempTables();
+
+        msg.sprintf("Skipped placement, no matches changed, "
+                    "%.2f match + %.2f check", matchTime, checkTime);
+        LOG(VB_GENERAL, LOG_INFO, msg);
+        return false;
+    }
+
     gettimeofday(&fillstart, NULL);
     bool worklistused = FillRecordList();
     gettimeofday(&fillend, NULL);
@@ -2225,6 +2513,7 @@ bool Scheduler::HandleReschedule(void)
 
     if (worklistused)
     {
+        lastPlaceTime = MythDate::current();
         UpdateNextRecord();
         PrintList();
     }
@@ -3487,6 +3776,91 @@ static QString progfindid = QString(
         .arg(kFindWeeklyRecord)
         .arg(kOverrideRecord);
 
+/** \brief Returns a checksum over the recordmatch rows of a source or
+ *         multiplex and the program data the scheduler uses from them.
+ *
+ *  HandleReschedule() compares this with the value from the last time
+ *  the same scope was matched, to skip placement passes for EIT updates
+ *  that did not change anything. The duplicate columns are left out, they
+ *  are reset by every UpdateMatches() and changes to them arrive as CHECK
+ *  requests. Returns an empty string on error.
+ */
+QString Scheduler::GetMatchFingerprint(uint sourceid, uint mplexid,
+                                       const QDateTime &maxstarttime)
+{
+    QString where;
+    MSqlBindings bindings;
+    if (sourceid)
+    {
+        where += " AND channel.sourceid = :SOURCEID";
+        bindings[":SOURCEID"] = sourceid;
+    }
+    if (mplexid)
+    {
+        where += " AND channel.mplexid = :MPLEXID";
+        bindings[":MPLEXID"] = mplexid;
+    }
+    if (maxstarttime.isValid())
+    {
+        where += " AND recordmatch.starttime <= :MAXSTARTTIME";
+        bindings[":MAXSTARTTIME"] = maxstarttime;
+    }
+
+    MSqlQuery query(dbConn);
+    query.prepare(
+        "SELECT COUNT(*), "
+        "       SUM(CRC32(CONCAT_WS('|', "
+        "           recordmatch.recordid, recordmatch.chanid, "
+        "           recordmatch.starttime, recordmatch.manualid, "
+        "           recordmatch.findid, "
+        "           program.endtime, program.title, program.subtitle, "
+        "           program.description, program.category, "
+        "           program.category_type, program.seriesid, "
+        "           program.programid, program.airdate, "
+        "           program.originalairdate, program.stars, "
+        "           program.previouslyshown, program.first, program.last, "
+        "           program.generic, program.subtitletypes, "
+        "           program.audioprop, program.videoprop))) "
+        "FROM recordmatch "
+        "JOIN channel ON channel.chanid = recordmatch.chanid "
+        "LEFT JOIN program ON program.chanid    = recordmatch.chanid    AND "
+        "                     program.starttime = recordmatch.starttime AND "
+        "                     program.manualid  = recordmatch.manualid "
+        "WHERE 1" + where);
+    query.bindValues(bindings);
+
+    if (!query.exec() || !query.next())
+    {
+        MythDB::DBError("GetMatchFingerprint", query);
+        return QString();
+    }
+
+    return query.value(0).toString() + ":" + query.value(1).toString();
+}
+
+/** \brief Drops the match fingerprints of every scope that shares
+ *         recordmatch rows with the given source and multiplex.
+ *
+ *  Multiplexes belong to a single source, so scopes only stay valid when
+ *  both name a different source or both name a different multiplex.
+ */
+void Scheduler::ForgetMatchFingerprints(uint sourceid, uint mplexid)
+{
+    QMap<QString, QString>::iterator it = matchFingerprints.begin();
+    while (it != matchFingerprints.end())
+    {
+        QStringList ids = it.key().split(' ');
+        uint other_sourceid = ids[0].toUInt();
+        uint other_mplexid = ids[1].toUInt();
+
+        if ((sourceid && other_sourceid && sourceid != other_sourceid) ||
+            (mplexid && other_mplexid && mplexid != other_mplexid))
+            ++it;
+        else
+            it = matchFingerprints.erase(it);
+    }
+}
+
 void Scheduler::UpdateMatches(uint recordid, uint sourceid, uint mplexid,
                               const QDateTime maxstarttime)
 {
@@ -13,6 +13,7 @@ using namespace std;
 #include <QMutex>
 #include <QMap>
 #include <QSet>
+#include <QHash>
 
 // MythTV headers
 #include "filesysteminfo.h"
@@ -30,6 +31,28 @@ class AutoExpire;
 
 class Scheduler;
 
+/** \brief Time bucketed index over a RecList.
+ *
+ *  Finds the entries whose recording times may overlap those of a given
+ *  recording without walking the whole list. The candidates are returned
+ *  in list order, so walking them with Scheduler::FindNextConflict() gives
+ *  the same result as walking the full list.
+ */
+class RecListTimeIndex
+{
+  public:
+    void Build(const RecList &list);
+    void Clear(void);
+    void GetCandidates(const RecordingInfo *p, RecList &candidates) const;
+
+  private:
+    static uint Bucket(const QDateTime &dt);
+
+    vector<RecordingInfo*>     items;
+    QHash<uint, vector<uint> > buckets;
+    vector<uint>               unbounded; ///< entries spanning too many buckets
+};
+
 class Scheduler : public MThread, public MythScheduler
 {
   public:
@@ -75,6 +98,7 @@ class Scheduler : public MThread, public MythScheduler
     void PrintList(bool onlyFutureRecordings = false)
         { PrintList(reclist, onlyFutureRecordings); };
     void PrintList(RecList &list, bool onlyFutureRecordings = false);
+    void BenchmarkPlacement(uint count);
     void PrintRec(const RecordingInfo *p, const char *prefix = NULL);
 
     void SetMainServer(MainServer *ms);
@@ -108,8 +132,13 @@ class Scheduler : public MThread, public MythScheduler
     bool FillRecordList(void);
     void UpdateMatches(uint recordid, uint sourceid, uint mplexid, 
                        const QDateTime maxstarttime);
+    QString GetMatchFingerprint(uint sourceid, uint mplexid,
+                                const QDateTime &maxstarttime);
+    void ForgetMatchFingerprints(uint sourceid, uint mplexid);
     void UpdateManuals(uint recordid);
     void BuildWorkList(void);
+    void LoadMplexIDs(void);
+    void SetMplexIDs(RecList &list) const;
     bool ClearWorkList(void);
     void AddNewRecords(void);
     void AddNotListed(void);
@@ -128,6 +157,7 @@ class Scheduler : public MThread, public MythScheduler
                           int openEnd = 0) const;
     const RecordingInfo *FindConflict(const RecordingInfo *p, int openEnd = 0)
         const;
+    void GetConflictCandidates(const RecordingInfo *p, RecList &list) const;
     void MarkOtherShowings(RecordingInfo *p);
     void MarkShowingsList(RecList &showinglist, RecordingInfo *p);
     void BackupRecStatus(void);
@@ -206,13 +236,19 @@ class Scheduler : public MThread, public MythScheduler
     RecList worklist;
     RecList retrylist;
     RecList conflictlist;
+    RecListTimeIndex conflictindex;
     QMap<uint, RecList> recordidlistmap;
     QMap<QString, RecList> titlelistmap;
+    QMap<uint, uint> mplexidmap; ///< chanid -> mplexid, see LoadMplexIDs()
     InputGroupMap igrp;
 
     QDateTime schedTime;
     bool reclist_changed;
 
+    // Incremental rescheduling, see HandleReschedule()
+    QMap<QString, QString> matchFingerprints;
+    QDateTime lastPlaceTime;
+
     bool specsched;
     bool schedMoveHigher;
     bool schedulingEnabled;
@@ -18,11 +18,16 @@ using namespace std;
 #include "mythcontext.h"
 #include "programinfo.h"
 #include "mythplayer.h"
+#include "decoderbase.h"
+#include "mythcommflagplayer.h"
+#include "playercontext.h"
+#include "mthread.h"
 
 // Commercial Flagging headers
 #include "ClassicCommDetector.h"
 #include "ClassicLogoDetector.h"
 #include "ClassicSceneChangeDetector.h"
+#include "FrameAnalysisWorker.h"
 
 enum frameAspects {
     COMM_ASPECT_NORMAL = 0,
@@ -36,6 +41,89 @@ enum frameFormats {
     COMM_FORMAT_MAX
 } FrameFormats;
 
+class LogoCheckTask : public FrameAnalysisTask
+{
+  public:
+    LogoCheckTask(LogoDetectorBase *detector, unsigned char *frame) :
+        logoDetector(detector), framePtr(frame), logoPresent(false) {}
+
+    void run(void)
+    {
+        logoPresent = logoDetector->doesThisFrameContainTheFoundLogo(framePtr);
+    }
+
+    LogoDetectorBase *logoDetector;
+    unsigned char *framePtr;
+    bool logoPresent;
+};
+
+/** \class SegmentFlagger
+ *  \brief Flags one segment of a finished recording with its own player
+ *         and detector, then merges the result into the parent detector.
+ *
+ *   Decoding starts at "warmup", the keyframe before the segment, so the
+ *   scene change detector has a previous frame to compare with. Only the
+ *   frames from "start" up to "end" are merged, -1 meaning the end of file.
+ */
+class SegmentFlagger : public MThread
+{
+  public:
+    SegmentFlagger(ClassicCommDetector *parent, MythCommFlagPlayer *cfp,
+                   long long warmup, long long start, long long end,
+                   QAtomicInt *framesDone) :
+        MThread("CommFlagSegment"),
+        m_parent(parent), m_cfp(cfp),
+        m_warmup(warmup), m_start(start), m_end(end),
+        m_framesDone(framesDone), m_ok(false)
+    {
+    }
+
+    ~SegmentFlagger() { wait(); }
+
+    bool IsOK(void) const { return m_ok; }
+
+  protected:
+    void run(void)
+    {
+        RunProlog();
+
+        PlayerContext *ctx = m_cfp->CreateSegmentPlayer();
+        if (ctx)
+        {
+            ClassicCommDetector *detector = new ClassicCommDetector(
+                m_parent->commDetectMethod, false, m_parent->fullSpeed,
+                ctx->player, m_parent->startedAt, m_parent->stopsAt,
+                m_parent->recordingStartedAt, m_parent->recordingStopsAt);
+
+            m_ok = detector->FlagSegment(
+                m_parent, m_warmup, m_start, m_end, m_framesDone);
+
+            if (m_ok)
+            {
+                QMutexLocker locker(&m_parent->segmentLock);
+                m_parent->MergeSegment(detector, m_start, m_end);
+            }
+
+            // This thread has no event loop to run deleteLater(), and
+            // the logo detector belongs to the parent
+            delete detector->sceneChangeDetector;
+            delete detector;
+            delete ctx;
+        }
+
+        RunEpilog();
+    }
+
+  private:
+    ClassicCommDetector *m_parent;
+    MythCommFlagPlayer  *m_cfp;
+    long long            m_warmup;
+    long long            m_start;
+    long long            m_end;
+    QAtomicInt          *m_framesDone;
+    bool                 m_ok;
+};
+
 static QString toStringFrameMaskValues(int mask, bool verbose)
 {
     QString msg;
@@ -138,10 +226,12 @@ ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
     totalMinBrightness(0),                     detectBlankFrames(false),
     detectSceneChanges(false),                 detectStationLogo(false),
     logoInfoAvailable(false),                  logoDetector(0),
+    logoWorker(0),
     framePtr(0),                               frameIsBlank(false),
     sceneHasChanged(false),                    stationLogoPresent(false),
     lastFrameWasBlank(false),                  lastFrameWasSceneChange(false),
     decoderFoundAspectChanges(false),          sceneChangeDetector(0),
+    sceneFrameOffset(0),                       segmentDuration(0),
     player(player_in),
     startedAt(startedAt_in),                   stopsAt(stopsAt_in),
     recordingStartedAt(recordingStartedAt_in),
@@ -285,6 +375,9 @@ void ClassicCommDetector::deleteLater(void)
     if (logoDetector)
         logoDetector->deleteLater();
 
+    delete logoWorker;
+    logoWorker = NULL;
+
     CommDetectorBase::deleteLater();
 }
 
@@ -373,6 +466,23 @@ bool ClassicCommDetector::go()
     if (m_bStop)
         return false;
 
+    if (m_bMultiThreaded && logoInfoAvailable &&
+        (commDetectMethod & COMM_DETECT_LOGO) && !logoWorker)
+    {
+        logoWorker = new FrameAnalysisWorker("ClassicLogoCheck");
+    }
+
+    if ((m_segments > 1) && (!stillRecording))
+    {
+        MythCommFlagPlayer *cfp = dynamic_cast<MythCommFlagPlayer*>(player);
+        QList<long long> starts;
+        if (cfp && SplitIntoSegments(cfp, starts))
+            return FlagSegments(cfp, starts);
+
+        LOG(VB_COMMFLAG, LOG_INFO,
+            "Recording is too short to split, flagging it in one pass.");
+    }
+
     QTime flagTime;
     flagTime.start();
 
@@ -592,9 +702,278 @@ bool ClassicCommDetector::go()
     return true;
 }
 
+/** \brief Picks keyframe aligned start frames for up to m_segments
+ *         segments of the recording.
+ *
+ *  \return false if the recording can't be split into two or more.
+ */
+bool ClassicCommDetector::SplitIntoSegments(MythCommFlagPlayer *cfp,
+                                            QList<long long> &starts)
+{
+    long long totalFrames = cfp->GetTotalFrameCount();
+
+    // Segments shorter than a few minutes aren't worth another player
+    long long minFrames = (long long)(fps * 180);
+    long long segments = m_segments;
+    if (minFrames > 0)
+        segments = min(segments, totalFrames / minFrames);
+
+    starts.clear();
+    starts.push_back(0);
+    for (long long i = 1; i < segments; i++)
+    {
+        long long keyframe = cfp->GetKeyframeBefore(totalFrames * i / segments);
+        if (keyframe > starts.back())
+            starts.push_back(keyframe);
+    }
+
+    return starts.size() > 1;
+}
+
+/// Flags each segment on its own thread and waits for all of them.
+bool ClassicCommDetector::FlagSegments(MythCommFlagPlayer *cfp,
+                                       const QList<long long> &starts)
+{
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("Flagging recording as %1 segments in parallel")
+            .arg(starts.size()));
+
+    // Only the segment players decode the whole recording, don't let the
+    // logo search be saved as its duration. The segment durations are
+    // added up in MergeSegment() instead.
+    player->ResetTotalDuration();
+    segmentDuration = 0;
+
+    QTime flagTime;
+    flagTime.start();
+
+    long long myTotalFrames = player->GetTotalFrameCount();
+    QAtomicInt framesDone(0);
+
+    QList<SegmentFlagger*> flaggers;
+    for (int i = 0; i < starts.size(); i++)
+    {
+        long long warmup = (i == 0) ? 0 : cfp->GetKeyframeBefore(starts[i] - 1);
+        if (warmup < 0)
+            warmup = starts[i];
+        long long end = (i + 1 < starts.size()) ? starts[i + 1] : -1;
+
+        LOG(VB_COMMFLAG, LOG_INFO,
+            QString("Segment %1 covers frames %2 to %3 (decoding from %4)")
+                .arg(i).arg(starts[i]).arg(end).arg(warmup));
+
+        SegmentFlagger *flagger = new SegmentFlagger(
+            this, cfp, warmup, starts[i], end, &framesDone);
+        flagger->start();
+        flaggers.push_back(flagger);
+    }
+
+    int prevpercent = -1;
+    QList<SegmentFlagger*>::iterator it = flaggers.begin();
+    while (it != flaggers.end())
+    {
+        if (!(*it)->wait(1000))
+        {
+            emit breathe();
+
+            long long frames = framesDone.fetchAndAddRelaxed(0);
+            float elapsed = flagTime.elapsed() / 1000.0;
+            float flagFPS = (elapsed) ? frames / elapsed : 0.0;
+            int percentage = (myTotalFrames) ?
+                min(frames * 100 / myTotalFrames, 100LL) : 0;
+
+            if (showProgress)
+            {
+                QString tmp = QString("\r%1%/%2fps  \r")
+                    .arg(percentage, 3).arg((int)flagFPS, 4);
+                cerr << qPrintable(tmp) << flush;
+            }
+
+            emit statusUpdate(QObject::tr("%1% Completed @ %2 fps.")
+                              .arg(percentage).arg(flagFPS));
+
+            if (percentage % 10 == 0 && prevpercent != percentage)
+            {
+                prevpercent = percentage;
+                LOG(VB_GENERAL, LOG_INFO, QString("%1%% Completed @ %2 fps.")
+                    .arg(percentage) .arg(flagFPS));
+            }
+            continue;
+        }
+        ++it;
+    }
+
+    bool ok = !m_bStop;
+    for (it = flaggers.begin(); it != flaggers.end(); ++it)
+    {
+        ok &= (*it)->IsOK();
+        delete *it;
+    }
+
+    if (showProgress)
+    {
+        cerr << "\b\b\b\b\b\b      \b\b\b\b\b\b";
+        cerr.flush();
+    }
+
+    if (!ok)
+        LOG(VB_GENERAL, LOG_ERR, "Unable to flag every segment.");
+    else if (player->GetDecoder())
+        player->GetDecoder()->AddTotalDuration(segmentDuration);
+
+    return ok;
+}
+
+/** \brief Runs this detector over one segment of the recording.
+ *
+ *   This detector uses the parent's logo detector, which is only read.
+ */
+bool ClassicCommDetector::FlagSegment(
+    const ClassicCommDetector *parent,
+    long long warmup, long long start, long long end, QAtomicInt *framesDone)
+{
+    if (player->OpenFile() < 0)
+        return false;
+
+    Init();
+
+    aggressiveDetection = parent->aggressiveDetection;
+    logoDetector        = parent->logoDetector;
+    logoInfoAvailable   = parent->logoInfoAvailable;
+
+    if (!player->InitVideo())
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "NVP: Unable to initialize video for segment flagging.");
+        return false;
+    }
+    player->EnableSubtitles(false);
+
+    float aspect = player->GetVideoAspect();
+    float newAspect = aspect;
+
+    SetVideoParams(aspect);
+
+    // Frame numbers start at the warm up frame, not at zero
+    if (warmup > 0)
+        lastFrameNumber = warmup - 1;
+    sceneFrameOffset = warmup;
+
+    long long seekFrame = warmup;
+    bool inSegment = (warmup >= start);
+    while (!player->GetEof())
+    {
+        VideoFrame* currentFrame = player->GetRawVideoFrame(seekFrame);
+        long long currentFrameNumber = currentFrame->frameNumber;
+        seekFrame = -1;
+
+        if ((end >= 0) && (currentFrameNumber >= end))
+        {
+            player->DiscardVideoFrame(currentFrame);
+            break;
+        }
+
+        newAspect = currentFrame->aspect;
+        if (newAspect != aspect)
+        {
+            SetVideoParams(aspect);
+            aspect = newAspect;
+        }
+
+        if (parent->m_bStop)
+        {
+            player->DiscardVideoFrame(currentFrame);
+            return false;
+        }
+
+        while (parent->m_bPaused)
+            sleep(1);
+
+        // sleep a little so we don't use all cpu even if we're niced
+        if (!fullSpeed)
+            usleep(10000);
+
+        // Only count the duration of the segment itself, to within the
+        // few frames the decoder reads ahead
+        if (!inSegment && currentFrameNumber >= start)
+        {
+            player->ResetTotalDuration();
+            inSegment = true;
+        }
+
+        ProcessFrame(currentFrame, currentFrameNumber);
+
+        if (currentFrameNumber >= start)
+            framesDone->fetchAndAddRelaxed(1);
+
+        player->DiscardVideoFrame(currentFrame);
+    }
+
+    return true;
+}
+
+/** \brief Copies what a segment detector found for frames start up to end
+ *         into this detector, call with segmentLock held.
+ */
+void ClassicCommDetector::MergeSegment(
+    const ClassicCommDetector *segment, long long start, long long end)
+{
+    // The first segment also has the placeholder for frame -1
+    QMap<long long, FrameInfoEntry>::const_iterator fit = (start > 0) ?
+        segment->frameInfo.lowerBound(start) : segment->frameInfo.begin();
+    for (; fit != segment->frameInfo.end(); ++fit)
+    {
+        if ((end >= 0) && (fit.key() >= end))
+            break;
+
+        frameInfo[fit.key()] = *fit;
+
+        if (fit->flagMask & COMM_FRAME_SKIPPED)
+            continue;
+
+        framesProcessed++;
+        if (fit->minBrightness >= 0)
+            totalMinBrightness += fit->minBrightness;
+        if (fit->flagMask & COMM_FRAME_ASPECT_CHANGE)
+            decoderFoundAspectChanges = true;
+    }
+
+    frm_dir_map_t::const_iterator mit =
+        segment->blankFrameMap.lowerBound(start);
+    for (; mit != segment->blankFrameMap.end(); ++mit)
+    {
+        if ((end >= 0) && ((long long)mit.key() >= end))
+            break;
+        blankFrameMap[mit.key()] = *mit;
+        blankFrameCount++;
+    }
+
+    mit = segment->sceneMap.lowerBound(start);
+    for (; mit != segment->sceneMap.end(); ++mit)
+    {
+        if ((end >= 0) && ((long long)mit.key() >= end))
+            break;
+        sceneMap[mit.key()] = *mit;
+    }
+
+    if (segment->player->GetDecoder())
+        segmentDuration += segment->player->GetDecoder()->GetTotalDuration();
+
+    // The last segment leaves the detector in its final state
+    if (end < 0)
+    {
+        lastFrameNumber      = segment->lastFrameNumber;
+        curFrameNumber       = segment->curFrameNumber;
+        currentAspect        = segment->currentAspect;
+        commDetectDimAverage = segment->commDetectDimAverage;
+    }
+}
+
 void ClassicCommDetector::sceneChangeDetectorHasNewInformation(
-    unsigned int framenum,bool isSceneChange,float debugValue)
+    unsigned int framenum_in,bool isSceneChange,float debugValue)
 {
+    long long framenum = framenum_in + sceneFrameOffset;
+
     if (isSceneChange)
     {
         frameInfo[framenum].flagMask |= COMM_FRAME_SCENE_CHANGE;
@@ -803,6 +1182,14 @@ void ClassicCommDetector::ProcessFrame(VideoFrame *frame,
 
     frameInfo[curFrameNumber] = fInfo;
 
+    // The logo check only reads the frame, let it run alongside the
+    // blank frame and scene change checks.
+    LogoCheckTask logoCheck(logoDetector, framePtr);
+    bool checkLogo =
+        (logoInfoAvailable) && (commDetectMethod & COMM_DETECT_LOGO);
+    if (checkLogo && logoWorker)
+        logoWorker->begin(&logoCheck);
+
     if (commDetectMethod & COMM_DETECT_BLANKS)
         frameIsBlank = false;
 
@@ -935,10 +1322,13 @@ void ClassicCommDetector::ProcessFrame(VideoFrame *frame,
             frameIsBlank = true;
     }
 
-    if ((logoInfoAvailable) && (commDetectMethod & COMM_DETECT_LOGO))
+    if (checkLogo)
     {
-        stationLogoPresent =
-            logoDetector->doesThisFrameContainTheFoundLogo(framePtr);
+        if (logoWorker)
+            logoWorker->finish();
+        else
+            logoCheck.run();
+        stationLogoPresent = logoCheck.logoPresent;
     }
 
 #if 0
@@ -7,6 +7,9 @@
 // Qt headers
 #include <QObject>
 #include <QMap>
+#include <QMutex>
+#include <QList>
+#include <QAtomicInt>
 #include <QDateTime>
 
 // MythTV headers
@@ -17,7 +20,9 @@
 #include "CommDetectorBase.h"
 
 class MythPlayer;
+class MythCommFlagPlayer;
 class LogoDetectorBase;
+class FrameAnalysisWorker;
 class SceneChangeDetectorBase;
 
 enum frameMaskValues {
@@ -68,6 +73,7 @@ class ClassicCommDetector : public CommDetectorBase
         void logoDetectorBreathe();
 
         friend class ClassicLogoDetector;
+        friend class SegmentFlagger;
 
     protected:
         virtual ~ClassicCommDetector() {}
@@ -112,6 +118,16 @@ class ClassicCommDetector : public CommDetectorBase
         void CleanupFrameInfo(void);
         void GetLogoCommBreakMap(show_map_t &map);
 
+        bool SplitIntoSegments(MythCommFlagPlayer *cfp,
+                               QList<long long> &starts);
+        bool FlagSegments(MythCommFlagPlayer *cfp,
+                          const QList<long long> &starts);
+        bool FlagSegment(const ClassicCommDetector *parent,
+                         long long warmup, long long start, long long end,
+                         QAtomicInt *framesDone);
+        void MergeSegment(const ClassicCommDetector *segment,
+                          long long start, long long end);
+
         enum SkipTypes commDetectMethod;
         frm_dir_map_t lastSentCommBreakMap;
         bool commBreakMapUpdateRequested;
@@ -152,6 +168,7 @@ class ClassicCommDetector : public CommDetectorBase
 
         bool logoInfoAvailable;
         LogoDetectorBase* logoDetector;
+        FrameAnalysisWorker* logoWorker;
 
         unsigned char *framePtr;
 
@@ -172,6 +189,10 @@ class ClassicCommDetector : public CommDetectorBase
         bool decoderFoundAspectChanges;
 
         SceneChangeDetectorBase* sceneChangeDetector;
+        long long sceneFrameOffset;
+
+        QMutex segmentLock;
+        int64_t segmentDuration; ///< decoded by the segments, in usec
 
 protected:
         MythPlayer *player;
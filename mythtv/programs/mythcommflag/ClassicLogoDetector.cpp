@@ -29,7 +29,7 @@ ClassicLogoDetector::ClassicLogoDetector(ClassicCommDetector* commdetector,
                                          unsigned int xspacing_in,
                                          unsigned int yspacing_in)
     : LogoDetectorBase(w,h),
-      commDetector(commdetector),                       frameNumber(0),
+      commDetector(commdetector),
       previousFrameWasSceneChange(false),
       xspacing(xspacing_in),                            yspacing(yspacing_in),
       commDetectBorder(commdetectborder_in),            edgeMask(new EdgeMaskEntry[width * height]),
@@ -494,7 +494,6 @@ bool ClassicLogoDetector::doesThisFrameContainTheFoundLogo(
         }
     }
 
-    frameNumber++;
     double goodEdgeRatio = (double)goodEdges / (double)testEdges;
     double badEdgeRatio = (double)badEdges / (double)testNotEdges;
     if ((goodEdgeRatio > commDetectLogoGoodEdgeThreshold) &&
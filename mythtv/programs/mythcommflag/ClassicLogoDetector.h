@@ -31,7 +31,6 @@ class ClassicLogoDetector : public LogoDetectorBase
     void DetectEdges(VideoFrame *frame, EdgeMaskEntry *edges, int edgeDiff);
 
     ClassicCommDetector* commDetector;
-    unsigned int frameNumber;
     bool previousFrameWasSceneChange;
     unsigned int xspacing, yspacing;
     unsigned int commDetectBorder;
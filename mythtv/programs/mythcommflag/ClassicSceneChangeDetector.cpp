@@ -18,11 +18,10 @@ ClassicSceneChangeDetector::ClassicSceneChangeDetector(unsigned int width,
     previousHistogram = new Histogram;
 }
 
-void ClassicSceneChangeDetector::deleteLater(void)
+ClassicSceneChangeDetector::~ClassicSceneChangeDetector()
 {
     delete histogram;
     delete previousHistogram;
-    SceneChangeDetectorBase::deleteLater();
 }
 
 void ClassicSceneChangeDetector::processFrame(unsigned char* frame)
@@ -11,13 +11,10 @@ class ClassicSceneChangeDetector : public SceneChangeDetectorBase
     ClassicSceneChangeDetector(unsigned int width, unsigned int height,
         unsigned int commdetectborder, unsigned int xspacing,
         unsigned int yspacing);
-    virtual void deleteLater(void);
+    virtual ~ClassicSceneChangeDetector();
 
     void processFrame(unsigned char* frame);
 
-  private:
-    ~ClassicSceneChangeDetector() {}
-
   private:
     Histogram* histogram;
     Histogram* previousHistogram;
@@ -12,6 +12,7 @@ using namespace std;
 // Qt headers
 #include <QDir>
 #include <QFileInfo>
+#include <QScopedPointer>
 
 // MythTV headers
 #include "compat.h"
@@ -25,6 +26,7 @@ using namespace std;
 #include "CommDetector2.h"
 #include "CannyEdgeDetector.h"
 #include "FrameAnalyzer.h"
+#include "FrameAnalysisWorker.h"
 #include "PGMConverter.h"
 #include "BorderDetector.h"
 #include "HistogramAnalyzer.h"
@@ -115,20 +117,88 @@ bool MythPlayerInited(FrameAnalyzerItem &pass,
     return true;
 }
 
+class AnalyzeFrameTask : public FrameAnalysisTask
+{
+public:
+    AnalyzeFrameTask(FrameAnalyzer *_analyzer, const VideoFrame *_frame,
+            long long _frameno)
+        : analyzer(_analyzer), frame(_frame), frameno(_frameno)
+        , ares(FrameAnalyzer::ANALYZE_ERROR), nextFrame(0) {}
+
+    void run(void)
+    {
+        ares = analyzer->analyzeFrame(frame, frameno, &nextFrame);
+    }
+
+    FrameAnalyzer                       *analyzer;
+    const VideoFrame                    *frame;
+    long long                           frameno;
+    FrameAnalyzer::analyzeFrameResult   ares;
+    long long                           nextFrame;
+};
+
 long long processFrame(FrameAnalyzerItem &pass,
                        FrameAnalyzerItem &finishedAnalyzers,
                        FrameAnalyzerItem &deadAnalyzers,
                        const VideoFrame *frame,
-                       long long frameno)
+                       long long frameno,
+                       FrameAnalysisWorker *worker = NULL,
+                       FrameAnalyzer *offload = NULL)
 {
     long long nextFrame;
     long long minNextFrame = FrameAnalyzer::ANYFRAME;
 
+    /*
+     * Run "offload" on the worker thread while the other analyzers of the
+     * pass look at the same frame here. The results are gathered first and
+     * then acted upon in pass order, so the outcome is the same as running
+     * them one after the other.
+     */
+    vector<FrameAnalyzer::analyzeFrameResult> results;
+    vector<long long> nextFrames;
+    bool parallel = worker && offload && pass.size() > 1 &&
+        std::find(pass.begin(), pass.end(), offload) != pass.end();
+    if (parallel)
+    {
+        AnalyzeFrameTask task(offload, frame, frameno);
+        worker->begin(&task);
+
+        FrameAnalyzerItem::iterator it = pass.begin();
+        for (; it != pass.end(); ++it)
+        {
+            if (*it == offload)
+            {
+                results.push_back(FrameAnalyzer::ANALYZE_ERROR);
+                nextFrames.push_back(0);
+                continue;
+            }
+            results.push_back((*it)->analyzeFrame(frame, frameno, &nextFrame));
+            nextFrames.push_back(nextFrame);
+        }
+
+        worker->finish();
+
+        size_t pos = std::find(pass.begin(), pass.end(), offload) -
+            pass.begin();
+        results[pos] = task.ares;
+        nextFrames[pos] = task.nextFrame;
+    }
+
+    size_t ii = 0;
     FrameAnalyzerItem::iterator it = pass.begin();
     while (it != pass.end())
     {
-        FrameAnalyzer::analyzeFrameResult ares =
-            (*it)->analyzeFrame(frame, frameno, &nextFrame);
+        FrameAnalyzer::analyzeFrameResult ares;
+        if (parallel)
+        {
+            ares = results[ii];
+            nextFrame = nextFrames[ii];
+            ii++;
+        }
+        else
+        {
+            ares = (*it)->analyzeFrame(frame, frameno, &nextFrame);
+        }
 
         if ((FrameAnalyzer::ANALYZE_OK == ares) ||
             (FrameAnalyzer::ANALYZE_ERROR == ares))
@@ -321,12 +391,12 @@ CommDetector2::CommDetector2(
     isRecording(MythDate::current() < recendts),
     sendBreakMapUpdates(false),     breakMapUpdateRequested(false),
     finished(false),                currentFrameNumber(0),
+    pgmConverter(NULL),
     logoFinder(NULL),               logoMatcher(NULL),
     blankFrameDetector(NULL),       sceneChangeDetector(NULL),
     debugdir("")
 {
     FrameAnalyzerItem        pass0, pass1;
-    PGMConverter            *pgmConverter = NULL;
     BorderDetector          *borderDetector = NULL;
     HistogramAnalyzer       *histogramAnalyzer = NULL;
 
@@ -539,6 +609,15 @@ bool CommDetector2::go(void)
     QTime totalFlagTime;
     totalFlagTime.start();
 
+    /*
+     * Logo matching doesn't share any state with the blank frame and scene
+     * change detectors past the greyscale image, so it can look at each
+     * frame on its own thread.
+     */
+    QScopedPointer<FrameAnalysisWorker> worker;
+    if (m_bMultiThreaded && logoMatcher)
+        worker.reset(new FrameAnalysisWorker("CommDetector2"));
+
     /* If still recording, estimate the eventual total number of frames. */
     long long nframes = isRecording ?
         (long long)roundf((recstartts.secsTo(recendts) + 5) *
@@ -639,9 +718,23 @@ bool CommDetector2::go(void)
                         nframes, passno, npasses);
             }
 
+            /*
+             * The analyzers share the PGMConverter, fill it in before
+             * handing the frame to more than one thread.
+             */
+            FrameAnalyzer *offload = NULL;
+            int pgmwidth, pgmheight;
+            if (worker && pgmConverter &&
+                    pgmConverter->getImage(currentFrame, currentFrameNumber,
+                        &pgmwidth, &pgmheight))
+            {
+                offload = logoMatcher;
+            }
+
             nextFrame = processFrame(
                 *currentPass, finishedAnalyzers,
-                deadAnalyzers, currentFrame, currentFrameNumber);
+                deadAnalyzers, currentFrame, currentFrameNumber,
+                worker.data(), offload);
 
             if (((currentFrameNumber >= 1) &&
                  (((nextFrame * 10) / nframes) !=
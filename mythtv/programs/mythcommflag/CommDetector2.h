@@ -16,6 +16,7 @@ using namespace std;
 #include "FrameAnalyzer.h"
 
 class MythPlayer;
+class PGMConverter;
 class TemplateFinder;
 class TemplateMatcher;
 class BlankFrameDetector;
@@ -75,6 +76,7 @@ class CommDetector2 : public CommDetectorBase
 
     FrameAnalyzer::FrameMap breaks;
 
+    PGMConverter            *pgmConverter;
     TemplateFinder          *logoFinder;
     TemplateMatcher         *logoMatcher;
     BlankFrameDetector      *blankFrameDetector;
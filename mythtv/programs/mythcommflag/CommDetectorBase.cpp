@@ -1,6 +1,8 @@
 #include "CommDetectorBase.h"
 
-CommDetectorBase::CommDetectorBase() : m_bPaused(false), m_bStop(false)
+CommDetectorBase::CommDetectorBase() :
+    m_bPaused(false), m_bStop(false), m_bMultiThreaded(false),
+    m_segments(1)
 {
 }
 
@@ -35,6 +35,11 @@ public:
     void stop();
     void pause();
     void resume();
+    /// Analyze each frame with more than one thread, call before go()
+    void setMultiThreaded(bool enable) { m_bMultiThreaded = enable; }
+    /// Flag a finished recording as this many segments at once, if the
+    /// detector supports it; call before go()
+    void setSegments(int segments) { m_segments = segments; }
 
     virtual void GetCommercialBreakList(frm_dir_map_t &comms) = 0;
     virtual void recordingFinished(long long totalFileSize)
@@ -53,6 +58,8 @@ protected:
     ~CommDetectorBase() {}
     bool m_bPaused;
     bool m_bStop;    
+    bool m_bMultiThreaded;
+    int m_segments;
     
 };
 
@@ -19,6 +19,7 @@ extern "C" {
 // Commercial Flagging headers
 #include "FrameAnalyzer.h"
 #include "EdgeDetector.h"
+#include "pixelkernels.h"
 
 namespace edgeDetector {
 
@@ -35,27 +36,31 @@ sgm_init_exclude(unsigned int *sgm, const AVPicture *src, int srcheight,
      * Intuitively, the SGM of a pixel is a measure of the "edge intensity" of
      * that pixel: how much it differs from its neighbors.
      */
-    const int       srcwidth = src->linesize[0];
-    int             rr, cc, dx, dy, rr2, cc2;
-    unsigned char   *rr0, *rr1;
+    const PixelKernels  *kernels = pixel_kernels();
+    const int           srcwidth = src->linesize[0];
+    int                 rr, rr2, cc2, skip1, skip2;
+    const unsigned char *rr0, *rr1;
 
     memset(sgm, 0, srcwidth * srcheight * sizeof(*sgm));
     rr2 = srcheight - 1;
     cc2 = srcwidth - 1;
     for (rr = 0; rr < rr2; rr++)
     {
-        for (cc = 0; cc < cc2; cc++)
+        rr0 = &src->data[0][rr * srcwidth];
+        rr1 = &src->data[0][(rr + 1) * srcwidth];
+
+        skip1 = cc2;
+        skip2 = cc2;
+        if (rr >= excluderow && rr < excluderow + excludeheight)
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                rr0 = &src->data[0][rr * srcwidth + cc];
-                rr1 = &src->data[0][(rr + 1) * srcwidth + cc];
-                dx = rr1[1] - rr0[0];   /* southeast - northwest */
-                dy = rr1[0] - rr0[1];   /* southwest - northeast */
-                sgm[rr * srcwidth + cc] = dx * dx + dy * dy;
-            }
+            /* Leave the excluded columns zeroed. */
+            skip1 = min(cc2, max(0, excludecol));
+            skip2 = max(skip1, min(cc2, excludecol + excludewidth));
         }
+
+        kernels->sgm_row(&sgm[rr * srcwidth], rr0, rr1, skip1);
+        kernels->sgm_row(&sgm[rr * srcwidth + skip2], rr0 + skip2,
+                rr1 + skip2, cc2 - skip2);
     }
     return sgm;
 }
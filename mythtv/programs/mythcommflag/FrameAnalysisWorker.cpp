@@ -0,0 +1,64 @@
+#include "FrameAnalysisWorker.h"
+
+FrameAnalysisWorker::FrameAnalysisWorker(const QString &name)
+    : MThread(name)
+    , task(NULL)
+    , stopping(false)
+{
+    start();
+}
+
+FrameAnalysisWorker::~FrameAnalysisWorker(void)
+{
+    lock.lock();
+    stopping = true;
+    wakeWorker.wakeAll();
+    lock.unlock();
+
+    wait();
+}
+
+void
+FrameAnalysisWorker::begin(FrameAnalysisTask *_task)
+{
+    QMutexLocker locker(&lock);
+    task = _task;
+    wakeWorker.wakeAll();
+}
+
+void
+FrameAnalysisWorker::finish(void)
+{
+    QMutexLocker locker(&lock);
+    while (task)
+        taskDone.wait(&lock);
+}
+
+void
+FrameAnalysisWorker::run(void)
+{
+    RunProlog();
+
+    QMutexLocker locker(&lock);
+    while (!stopping || task)
+    {
+        if (!task)
+        {
+            wakeWorker.wait(&lock);
+            continue;
+        }
+
+        FrameAnalysisTask *current = task;
+        locker.unlock();
+        current->run();
+        locker.relock();
+
+        task = NULL;
+        taskDone.wakeAll();
+    }
+    locker.unlock();
+
+    RunEpilog();
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
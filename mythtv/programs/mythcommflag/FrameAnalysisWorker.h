@@ -0,0 +1,49 @@
+/*
+ * FrameAnalysisWorker
+ *
+ * Runs one piece of per-frame analysis on its own thread, so independent
+ * analyzers can look at the same video frame at the same time.
+ */
+
+#ifndef __FRAMEANALYSISWORKER_H__
+#define __FRAMEANALYSISWORKER_H__
+
+#include <QWaitCondition>
+#include <QMutex>
+
+#include "mthread.h"
+
+class FrameAnalysisTask
+{
+public:
+    virtual ~FrameAnalysisTask(void) { }
+    virtual void run(void) = 0;
+};
+
+class FrameAnalysisWorker : public MThread
+{
+public:
+    FrameAnalysisWorker(const QString &name);
+    ~FrameAnalysisWorker(void);
+
+    /*
+     * Start "task" on the worker thread. The caller must call finish()
+     * before starting another task or touching the task's results.
+     */
+    void begin(FrameAnalysisTask *task);
+    void finish(void);
+
+protected:
+    virtual void run(void); // MThread
+
+private:
+    QMutex              lock;
+    QWaitCondition      wakeWorker;
+    QWaitCondition      taskDone;
+    FrameAnalysisTask   *task;          /* protected by lock */
+    bool                stopping;       /* protected by lock */
+};
+
+#endif  /* !__FRAMEANALYSISWORKER_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
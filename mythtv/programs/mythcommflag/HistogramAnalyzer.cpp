@@ -4,6 +4,10 @@
 // ANSI C headers
 #include <cmath>
 
+// C++ headers
+#include <algorithm>
+using namespace std;
+
 // MythTV headers
 #include "mythcorecontext.h"
 #include "mythplayer.h"
@@ -15,6 +19,7 @@
 #include "PGMConverter.h"
 #include "BorderDetector.h"
 #include "quickselect.h"
+#include "pixelkernels.h"
 #include "TemplateFinder.h"
 #include "HistogramAnalyzer.h"
 
@@ -308,6 +313,7 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
     static const int    CINC = 4;
 #define ROUNDUP(a,b)    (((a) + (b) - 1) / (b) * (b))
 
+    const PixelKernels  *kernels = pixel_kernels();
     const AVPicture     *pgm;
     int                 pgmwidth, pgmheight;
     bool                ismonochromatic;
@@ -315,7 +321,7 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
     unsigned int        borderpixels, livepixels, npixels, halfnpixels;
     unsigned char       *pp, bordercolor;
     unsigned long long  sumval, sumsquares;
-    int                 rr, cc, rr1, cc1, rr2, cc2, rr3, cc3;
+    int                 rr, nn, rr1, cc1, rr2, cc2, rr3, cc3;
     struct timeval      start, end, elapsed;
 
     if (lastframeno != UNCACHED && lastframeno == frameno)
@@ -363,21 +369,27 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
     histval[DEFAULT_COLOR] += borderpixels;
     for (rr = rr1; rr < rr2; rr += RINC)
     {
-        int rroffset = rr * pgmwidth;
+        const unsigned char *row = &pgm->data[0][rr * pgmwidth];
+        int skip1 = cc2, skip2 = cc2;
 
-        for (cc = cc1; cc < cc2; cc += CINC)
+        if (logo && rr >= logorr1 && rr <= logorr2)
         {
-            if (logo && rr >= logorr1 && rr <= logorr2 &&
-                    cc >= logocc1 && cc <= logocc2)
-                continue; /* Exclude logo area from analysis. */
-
-            unsigned char val = pgm->data[0][rroffset + cc];
-            *pp++ = val;
-            sumval += val;
-            sumsquares += val * val;
-            livepixels++;
-            histval[val]++;
+            /* Exclude logo area from analysis. */
+            skip1 = min(cc2, max(cc1, ROUNDUP(logocc1, CINC)));
+            skip2 = max(skip1, min(cc2, ROUNDUP(logocc2 + 1, CINC)));
         }
+
+        nn = (skip1 - cc1) / CINC;
+        kernels->sample(row + cc1, CINC, nn, pp, &sumval, &sumsquares,
+                histval);
+        pp += nn;
+        livepixels += nn;
+
+        nn = (cc2 - skip2) / CINC;
+        kernels->sample(row + skip2, CINC, nn, pp, &sumval, &sumsquares,
+                histval);
+        pp += nn;
+        livepixels += nn;
     }
     npixels = borderpixels + livepixels;
 
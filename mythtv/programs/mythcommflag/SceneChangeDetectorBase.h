@@ -11,15 +11,15 @@ class SceneChangeDetectorBase : public QObject
     SceneChangeDetectorBase(unsigned int w, unsigned int h) :
         width(w), height(h) {}
 
+    /// Threads without an event loop delete detectors directly.
+    virtual ~SceneChangeDetectorBase() {}
+
     virtual void processFrame(unsigned char *frame) = 0;
 
   signals:
     void haveNewInformation(unsigned int framenum, bool scenechange,
                             float debugValue = 0.0);
 
-  protected:
-    virtual ~SceneChangeDetectorBase() {}
-
   protected:
     unsigned int width, height;
 };
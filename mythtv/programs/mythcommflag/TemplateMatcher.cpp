@@ -27,6 +27,7 @@ using namespace std;
 #include "BlankFrameDetector.h"
 #include "TemplateFinder.h"
 #include "TemplateMatcher.h"
+#include "pixelkernels.h"
 
 using namespace commDetector2;
 using namespace frameAnalyzer;
@@ -36,14 +37,8 @@ namespace {
 int pgm_set(const AVPicture *pict, int height)
 {
     const int   width = pict->linesize[0];
-    const int   size = height * width;
-    int         score, ii;
 
-    score = 0;
-    for (ii = 0; ii < size; ii++)
-        if (pict->data[0][ii])
-            score++;
-    return score;
+    return pixel_kernels()->count_set(pict->data[0], height * width);
 }
 
 int pgm_match(const AVPicture *tmpl, const AVPicture *test, int height,
@@ -61,6 +56,14 @@ int pgm_match(const AVPicture *tmpl, const AVPicture *test, int height,
         return -1;
     }
 
+    if (!radius)
+    {
+        /* Without jitter, count the edge pixels set in both images. */
+        *pscore = pixel_kernels()->count_matched(tmpl->data[0],
+                test->data[0], height * width);
+        return 0;
+    }
+
     score = 0;
     for (rr = 0; rr < height; rr++)
     {
@@ -64,6 +64,13 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
         "off, blank, scene, blankscene, logo, all, "
         "d2, d2_logo, d2_blank, d2_scene, d2_all", "")
             ->SetGroup("Commflagging");
+    add("--multithreaded", "multithreaded", false,
+        "Decode and analyze each frame using more than one thread.", "")
+            ->SetGroup("Commflagging");
+    add("--segments", "segments", 0,
+        "Split a finished recording into this many parts and flag "
+        "them in parallel.", "")
+            ->SetGroup("Commflagging");
     add("--outputmethod", "outputmethod", "",
         "Format of output written to outputfile, essentials, full.", "")
             ->SetGroup("Commflagging");
@@ -86,6 +93,15 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
             ->SetGroup("Advanced");
     add("--dry-run", "dryrun", false,
         "Don't actually queue operation, just list what would be done", "");
+    add("--kernelbench", "kernelbench", "",
+        "Benchmark the frame analysis pixel kernels on a PGM frame, or a "
+        "directory of them.",
+        "Times the pixel kernels chosen for this CPU against the plain C "
+        "ones, and fails if they do not give identical results.")
+            ->SetGroup("Advanced");
+    add("--iterations", "iterations", 100,
+        "Number of times to run each kernel on each frame.", "")
+            ->SetChildOf("kernelbench");
 
     add("--sleep", "fullspeed", false, "", "")
             ->SetRemoved("If your system is incapable of performing\n"
@@ -0,0 +1,215 @@
+// ANSI C headers
+#include <cstdio>
+#include <climits>
+
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QDir>
+#include <QFileInfo>
+#include <QVector>
+
+// MythTV headers
+#include "mythlogging.h"
+#include "mythtimer.h"
+#include "exitcodes.h"
+
+// Commercial Flagging headers
+#include "pgm.h"
+#include "pixelkernels.h"
+#include "kernelbench.h"
+
+namespace {
+
+enum { SAMPLE, SGM, SET, MATCH, NKERNELS };
+
+const char *kernelNames[NKERNELS] = { "sample", "sgm", "set", "match" };
+
+struct KernelResults
+{
+    QVector<unsigned char>  samples;
+    unsigned long long      sum;
+    unsigned long long      sumsquares;
+    QVector<int>            hist;
+    QVector<unsigned int>   sgm;
+    int                     set;
+    int                     matched;
+    int                     msecs[NKERNELS];
+};
+
+bool
+readFrame(const QString &filename, QVector<unsigned char> &frame,
+        int *pwidth, int *pheight)
+{
+    QByteArray  fname = filename.toLocal8Bit();
+    FILE        *fp;
+    int         nn, maxgray;
+
+    if (!(fp = fopen(fname.constData(), "r")))
+        return false;
+    nn = fscanf(fp, "P5\n%20d %20d\n%20d\n", pwidth, pheight, &maxgray);
+    (void)fclose(fp);
+
+    if (nn != 3 || *pwidth < 2 || *pheight < 2 || maxgray != UCHAR_MAX)
+        return false;
+
+    frame.fill(0, *pwidth * *pheight);
+    return pgm_read(frame.data(), *pwidth, *pheight, fname.constData()) == 0;
+}
+
+/* Run the kernels the same way the frame analyzers do. */
+void
+runKernels(const PixelKernels *kernels, const unsigned char *frame,
+        const unsigned char *edges, int width, int height, int iterations,
+        KernelResults *res)
+{
+    static const int    RINC = 4;   /* HistogramAnalyzer sampling */
+    static const int    CINC = 4;
+    const int           nsamples = width / CINC;
+    MythTimer           timer;
+
+    res->samples.fill(0, (height + RINC - 1) / RINC * nsamples);
+    res->hist.fill(0, UCHAR_MAX + 1);
+    res->sgm.fill(0, width * height);
+
+    timer.start();
+    for (int ii = 0; ii < iterations; ii++)
+    {
+        unsigned char *pp = res->samples.data();
+
+        res->sum = 0;
+        res->sumsquares = 0;
+        res->hist.fill(0);
+        for (int rr = 0; rr < height; rr += RINC, pp += nsamples)
+            kernels->sample(&frame[rr * width], CINC, nsamples, pp,
+                    &res->sum, &res->sumsquares, res->hist.data());
+    }
+    res->msecs[SAMPLE] = timer.elapsed();
+
+    timer.start();
+    for (int ii = 0; ii < iterations; ii++)
+    {
+        for (int rr = 0; rr < height - 1; rr++)
+            kernels->sgm_row(&res->sgm[rr * width], &frame[rr * width],
+                    &frame[(rr + 1) * width], width - 1);
+    }
+    res->msecs[SGM] = timer.elapsed();
+
+    timer.start();
+    for (int ii = 0; ii < iterations; ii++)
+        res->set = kernels->count_set(edges, width * height);
+    res->msecs[SET] = timer.elapsed();
+
+    /* Match each row of edges against the next one. */
+    timer.start();
+    for (int ii = 0; ii < iterations; ii++)
+        res->matched = kernels->count_matched(edges, edges + width,
+                width * (height - 1));
+    res->msecs[MATCH] = timer.elapsed();
+}
+
+bool
+sameResults(const KernelResults &aa, const KernelResults &bb)
+{
+    return aa.samples == bb.samples && aa.sum == bb.sum &&
+        aa.sumsquares == bb.sumsquares && aa.hist == bb.hist &&
+        aa.sgm == bb.sgm && aa.set == bb.set && aa.matched == bb.matched;
+}
+
+QString
+benchRate(unsigned long long bytes, int msecs)
+{
+    return QString::number(
+        (double)bytes * 1000.0 / (1024.0 * 1024.0 * max(msecs, 1)), 'f', 2);
+}
+
+};  /* namespace */
+
+int
+pixel_kernel_bench(const QString &path, int iterations)
+{
+    const PixelKernels      *kernels = pixel_kernels();
+    const PixelKernels      *plain = pixel_kernels_c();
+    QFileInfoList           files;
+    QFileInfo               info(path);
+
+    if (info.isDir())
+        files = QDir(path).entryInfoList(QStringList("*.pgm"), QDir::Files,
+                QDir::Name);
+    else if (info.exists())
+        files << info;
+
+    if (files.isEmpty())
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+            QString("No PGM frames found in %1\n").arg(path));
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+
+    if (iterations < 1)
+        iterations = 1;
+
+    if (kernels == plain)
+        LOG(VB_STDIO|VB_FLUSH, logLevel,
+            "No SIMD pixel kernels for this CPU, timing plain C only\n");
+
+    for (int ff = 0; ff < files.size(); ff++)
+    {
+        QString                 name = files[ff].fileName();
+        QVector<unsigned char>  frame, edges;
+        KernelResults           res, res_c;
+        int                     width, height;
+
+        if (!readFrame(files[ff].filePath(), frame, &width, &height))
+        {
+            LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+                QString("%1: not a greyscale PGM frame\n").arg(name));
+            return GENERIC_EXIT_NOT_OK;
+        }
+
+        edges.fill(0, width * height);
+        for (int ii = 0; ii < width * height; ii++)
+            edges[ii] = frame[ii] > UCHAR_MAX / 2 ? UCHAR_MAX : 0;
+
+        runKernels(plain, frame.constData(), edges.constData(), width,
+                height, iterations, &res_c);
+        if (kernels != plain)
+            runKernels(kernels, frame.constData(), edges.constData(), width,
+                    height, iterations, &res);
+        else
+            res = res_c;
+
+        /* Rates are in frame bytes, whatever each kernel reads of them. */
+        unsigned long long total =
+            (unsigned long long)width * height * iterations;
+
+        for (int kk = 0; kk < NKERNELS; kk++)
+        {
+            if (kernels == plain)
+                LOG(VB_STDIO|VB_FLUSH, logLevel,
+                    QString("%1 (%2x%3): %4 %5 MB/s\n")
+                    .arg(name).arg(width).arg(height).arg(kernelNames[kk])
+                    .arg(benchRate(total, res_c.msecs[kk])));
+            else
+                LOG(VB_STDIO|VB_FLUSH, logLevel,
+                    QString("%1 (%2x%3): %4 %5 MB/s (plain C %6 MB/s)\n")
+                    .arg(name).arg(width).arg(height).arg(kernelNames[kk])
+                    .arg(benchRate(total, res.msecs[kk]))
+                    .arg(benchRate(total, res_c.msecs[kk])));
+        }
+
+        if (!sameResults(res, res_c))
+        {
+            LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+                QString("%1: %2 pixel kernels disagree with plain C\n")
+                .arg(name).arg(kernels->name));
+            return GENERIC_EXIT_NOT_OK;
+        }
+    }
+
+    return GENERIC_EXIT_OK;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
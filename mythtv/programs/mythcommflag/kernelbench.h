@@ -0,0 +1,21 @@
+/*
+ * kernelbench.h
+ *
+ * Times the pixel kernels on stored PGM frames, and checks that the kernels
+ * chosen for this CPU give the same results as the plain C ones.
+ */
+
+#ifndef __KERNELBENCH_H__
+#define __KERNELBENCH_H__
+
+class QString;
+
+/*
+ * "path" is a PGM file, or a directory of them. Returns a GENERIC_EXIT_*
+ * code.
+ */
+int pixel_kernel_bench(const QString &path, int iterations);
+
+#endif  /* !__KERNELBENCH_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -20,6 +20,7 @@ using namespace std;
 #include <QRegExp>
 #include <QDir>
 #include <QEvent>
+#include <QTime>
 
 // MythTV headers
 #include "mythmiscutil.h"
@@ -46,6 +47,7 @@ using namespace std;
 #include "CommDetectorFactory.h"
 #include "SlotRelayer.h"
 #include "CustomEventRelayer.h"
+#include "kernelbench.h"
 
 #define LOC      QString("MythCommFlag: ")
 #define LOC_WARN QString("MythCommFlag, Warning: ")
@@ -540,6 +542,7 @@ static int DoFlagCommercials(
     ProgramInfo *program_info,
     bool showPercentage, bool fullSpeed, int jobid,
     MythCommFlagPlayer* cfp, enum SkipTypes commDetectMethod,
+    bool multiThreaded, int segments,
     const QString &outputfilename, bool useDB)
 {
     CommDetectorFactory factory;
@@ -551,6 +554,8 @@ static int DoFlagCommercials(
         program_info->GetScheduledEndTime(),
         program_info->GetRecordingStartTime(),
         program_info->GetRecordingEndTime(), useDB);
+    commDetector->setMultiThreaded(multiThreaded);
+    commDetector->setSegments(segments);
 
     if (jobid > 0)
         LOG(VB_COMMFLAG, LOG_INFO,
@@ -579,9 +584,21 @@ static int DoFlagCommercials(
         gCoreContext->SendMessage(message);
     }
 
+    QTime flagTime;
+    flagTime.start();
+
     bool result = commDetector->go();
     int comms_found = 0;
 
+    int elapsed = flagTime.elapsed();
+    uint64_t frames = cfp->GetTotalFrameCount();
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("Flagged %1 frames in %2 seconds (%3 fps, %4, %5 segments)")
+            .arg(frames).arg(elapsed / 1000.0, 0, 'f', 1)
+            .arg(elapsed ? frames * 1000.0 / elapsed : 0.0, 0, 'f', 1)
+            .arg(multiThreaded ? "multithreaded" : "single threaded")
+            .arg(segments));
+
     if (result)
     {
         cfp->SaveTotalDuration();
@@ -878,11 +895,18 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
         }
     }
 
+    bool multiThreaded = cmdline.toBool("multithreaded") ||
+        gCoreContext->GetNumSetting("CommFlagMultiThreaded", 0);
+    int segments = cmdline.toBool("segments") ? cmdline.toInt("segments") :
+        gCoreContext->GetNumSetting("CommFlagSegments", 1);
+
     PlayerFlags flags = (PlayerFlags)(kAudioMuted   |
                                       kVideoIsNull  |
                                       kDecodeLowRes |
-                                      kDecodeSingleThreaded |
                                       kDecodeNoLoopFilter);
+    /* let the decoder use its own threads when flagging multithreaded. */
+    if (!multiThreaded)
+        flags = (PlayerFlags) (flags | kDecodeSingleThreaded);
     /* blank detector needs to be only sample center for this optimization. */
     if ((COMM_DETECT_BLANKS  == commDetectMethod) ||
         (COMM_DETECT_2_BLANK == commDetectMethod))
@@ -932,7 +956,7 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
 
     breaksFound = DoFlagCommercials(
         program_info, progress, fullSpeed, jobid,
-        cfp, commDetectMethod, outputfilename, useDB);
+        cfp, commDetectMethod, multiThreaded, segments, outputfilename, useDB);
 
     if (progress)
         cerr << breaksFound << "\n";
@@ -1121,6 +1145,10 @@ int main(int argc, char *argv[])
     if (retval != GENERIC_EXIT_OK)
         return retval;
 
+    if (cmdline.toBool("kernelbench"))
+        return pixel_kernel_bench(cmdline.toString("kernelbench"),
+                                  cmdline.toInt("iterations"));
+
     CleanupGuard callCleanup(cleanup);
 
 #ifndef _WIN32
@@ -17,10 +17,10 @@ HEADERS += ClassicCommDetector.h
 HEADERS += Histogram.h
 HEADERS += quickselect.h
 HEADERS += CommDetector2.h
-HEADERS += pgm.h
+HEADERS += pgm.h pixelkernels.h kernelbench.h
 HEADERS += EdgeDetector.h CannyEdgeDetector.h
 HEADERS += PGMConverter.h BorderDetector.h
-HEADERS += FrameAnalyzer.h
+HEADERS += FrameAnalyzer.h FrameAnalysisWorker.h
 HEADERS += TemplateFinder.h TemplateMatcher.h
 HEADERS += HistogramAnalyzer.h
 HEADERS += BlankFrameDetector.h
@@ -38,10 +38,10 @@ SOURCES += ClassicCommDetector.cpp
 SOURCES += Histogram.cpp
 SOURCES += quickselect.c
 SOURCES += CommDetector2.cpp
-SOURCES += pgm.cpp
+SOURCES += pgm.cpp pixelkernels.cpp kernelbench.cpp
 SOURCES += EdgeDetector.cpp CannyEdgeDetector.cpp
 SOURCES += PGMConverter.cpp BorderDetector.cpp
-SOURCES += FrameAnalyzer.cpp
+SOURCES += FrameAnalyzer.cpp FrameAnalysisWorker.cpp
 SOURCES += TemplateFinder.cpp TemplateMatcher.cpp
 SOURCES += HistogramAnalyzer.cpp
 SOURCES += BlankFrameDetector.cpp
@@ -0,0 +1,258 @@
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// avlib/ffmpeg headers
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+// MythTV headers
+#include "mythlogging.h"
+
+// Commercial Flagging headers
+#include "pixelkernels.h"
+
+namespace {
+
+void
+sample_c(const unsigned char *src, int step, int count, unsigned char *dst,
+        unsigned long long *sum, unsigned long long *sumsquares, int *hist)
+{
+    unsigned long long  sumval = 0, sumsq = 0;
+
+    for (int ii = 0; ii < count; ii++)
+    {
+        unsigned char val = src[ii * step];
+        dst[ii] = val;
+        sumval += val;
+        sumsq += val * val;
+        hist[val]++;
+    }
+    *sum += sumval;
+    *sumsquares += sumsq;
+}
+
+void
+sgm_row_c(unsigned int *sgm, const unsigned char *rr0,
+        const unsigned char *rr1, int count)
+{
+    for (int cc = 0; cc < count; cc++)
+    {
+        int dx = rr1[cc + 1] - rr0[cc];     /* southeast - northwest */
+        int dy = rr1[cc] - rr0[cc + 1];     /* southwest - northeast */
+        sgm[cc] = dx * dx + dy * dy;
+    }
+}
+
+int
+count_set_c(const unsigned char *pp, int count)
+{
+    int score = 0;
+
+    for (int ii = 0; ii < count; ii++)
+        if (pp[ii])
+            score++;
+    return score;
+}
+
+int
+count_matched_c(const unsigned char *aa, const unsigned char *bb, int count)
+{
+    int score = 0;
+
+    for (int ii = 0; ii < count; ii++)
+        if (aa[ii] && bb[ii])
+            score++;
+    return score;
+}
+
+const PixelKernels kernels_c = {
+    "C", sample_c, sgm_row_c, count_set_c, count_matched_c,
+};
+
+#if defined(__SSE2__)
+
+inline unsigned long long
+sum_epi64(__m128i vv)
+{
+    unsigned long long halves[2];
+
+    _mm_storeu_si128((__m128i*)halves, vv);
+    return halves[0] + halves[1];
+}
+
+void
+sample_sse2(const unsigned char *src, int step, int count, unsigned char *dst,
+        unsigned long long *sum, unsigned long long *sumsquares, int *hist)
+{
+    if (step != 4)
+    {
+        sample_c(src, step, count, dst, sum, sumsquares, hist);
+        return;
+    }
+
+    const __m128i   zero = _mm_setzero_si128();
+    const __m128i   lowbyte = _mm_set1_epi32(0xff);
+    __m128i         sumval = zero, sumsq = zero;
+    int             ii;
+
+    /*
+     * Each pass loads 64 bytes for 16 samples; the last 3 bytes belong to
+     * the next sample, so stop while there still is one.
+     */
+    for (ii = 0; ii + 16 < count; ii += 16)
+    {
+        const __m128i *pp = (const __m128i*)(src + ii * 4);
+        __m128i aa = _mm_and_si128(_mm_loadu_si128(pp + 0), lowbyte);
+        __m128i bb = _mm_and_si128(_mm_loadu_si128(pp + 1), lowbyte);
+        __m128i cc = _mm_and_si128(_mm_loadu_si128(pp + 2), lowbyte);
+        __m128i dd = _mm_and_si128(_mm_loadu_si128(pp + 3), lowbyte);
+        __m128i lo = _mm_packs_epi32(aa, bb);       /* 8 x 16-bit */
+        __m128i hi = _mm_packs_epi32(cc, dd);
+        __m128i vals = _mm_packus_epi16(lo, hi);    /* 16 x 8-bit */
+        __m128i sq = _mm_add_epi32(_mm_madd_epi16(lo, lo),
+                _mm_madd_epi16(hi, hi));
+
+        _mm_storeu_si128((__m128i*)(dst + ii), vals);
+        sumval = _mm_add_epi64(sumval, _mm_sad_epu8(vals, zero));
+        sumsq = _mm_add_epi64(sumsq, _mm_add_epi64(
+                    _mm_unpacklo_epi32(sq, zero),
+                    _mm_unpackhi_epi32(sq, zero)));
+
+        for (int jj = 0; jj < 16; jj++)
+            hist[dst[ii + jj]]++;
+    }
+    *sum += sum_epi64(sumval);
+    *sumsquares += sum_epi64(sumsq);
+
+    sample_c(src + ii * 4, 4, count - ii, dst + ii, sum, sumsquares, hist);
+}
+
+void
+sgm_row_sse2(unsigned int *sgm, const unsigned char *rr0,
+        const unsigned char *rr1, int count)
+{
+    const __m128i   zero = _mm_setzero_si128();
+    int             cc;
+
+    for (cc = 0; cc + 16 <= count; cc += 16)
+    {
+        __m128i nw = _mm_loadu_si128((const __m128i*)(rr0 + cc));
+        __m128i ne = _mm_loadu_si128((const __m128i*)(rr0 + cc + 1));
+        __m128i sw = _mm_loadu_si128((const __m128i*)(rr1 + cc));
+        __m128i se = _mm_loadu_si128((const __m128i*)(rr1 + cc + 1));
+
+        /* dx, dy of pixels 0-7 and 8-15, widened to 16 bits */
+        __m128i dxlo = _mm_sub_epi16(_mm_unpacklo_epi8(se, zero),
+                _mm_unpacklo_epi8(nw, zero));
+        __m128i dylo = _mm_sub_epi16(_mm_unpacklo_epi8(sw, zero),
+                _mm_unpacklo_epi8(ne, zero));
+        __m128i dxhi = _mm_sub_epi16(_mm_unpackhi_epi8(se, zero),
+                _mm_unpackhi_epi8(nw, zero));
+        __m128i dyhi = _mm_sub_epi16(_mm_unpackhi_epi8(sw, zero),
+                _mm_unpackhi_epi8(ne, zero));
+
+        /* Interleave dx and dy so that madd yields dx * dx + dy * dy. */
+        __m128i vv;
+        __m128i *out = (__m128i*)(sgm + cc);
+
+        vv = _mm_unpacklo_epi16(dxlo, dylo);
+        _mm_storeu_si128(out + 0, _mm_madd_epi16(vv, vv));
+        vv = _mm_unpackhi_epi16(dxlo, dylo);
+        _mm_storeu_si128(out + 1, _mm_madd_epi16(vv, vv));
+        vv = _mm_unpacklo_epi16(dxhi, dyhi);
+        _mm_storeu_si128(out + 2, _mm_madd_epi16(vv, vv));
+        vv = _mm_unpackhi_epi16(dxhi, dyhi);
+        _mm_storeu_si128(out + 3, _mm_madd_epi16(vv, vv));
+    }
+
+    sgm_row_c(sgm + cc, rr0 + cc, rr1 + cc, count - cc);
+}
+
+int
+count_set_sse2(const unsigned char *pp, int count)
+{
+    const __m128i   zero = _mm_setzero_si128();
+    const __m128i   one = _mm_set1_epi8(1);
+    __m128i         score = zero;
+    int             ii;
+
+    for (ii = 0; ii + 16 <= count; ii += 16)
+    {
+        __m128i vv = _mm_loadu_si128((const __m128i*)(pp + ii));
+        __m128i set = _mm_andnot_si128(_mm_cmpeq_epi8(vv, zero), one);
+        score = _mm_add_epi64(score, _mm_sad_epu8(set, zero));
+    }
+
+    return (int)sum_epi64(score) + count_set_c(pp + ii, count - ii);
+}
+
+int
+count_matched_sse2(const unsigned char *aa, const unsigned char *bb,
+        int count)
+{
+    const __m128i   zero = _mm_setzero_si128();
+    const __m128i   one = _mm_set1_epi8(1);
+    __m128i         score = zero;
+    int             ii;
+
+    for (ii = 0; ii + 16 <= count; ii += 16)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i*)(aa + ii));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(bb + ii));
+        __m128i unset = _mm_or_si128(_mm_cmpeq_epi8(va, zero),
+                _mm_cmpeq_epi8(vb, zero));
+        score = _mm_add_epi64(score,
+                _mm_sad_epu8(_mm_andnot_si128(unset, one), zero));
+    }
+
+    return (int)sum_epi64(score) +
+        count_matched_c(aa + ii, bb + ii, count - ii);
+}
+
+const PixelKernels kernels_sse2 = {
+    "SSE2", sample_sse2, sgm_row_sse2, count_set_sse2, count_matched_sse2,
+};
+
+#endif  /* __SSE2__ */
+
+const PixelKernels *
+select_kernels(void)
+{
+    const PixelKernels *kernels = pixel_kernels_sse2();
+
+    if (!kernels)
+        kernels = &kernels_c;
+
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("Using %1 pixel kernels").arg(kernels->name));
+    return kernels;
+}
+
+};  /* namespace */
+
+const PixelKernels *
+pixel_kernels(void)
+{
+    static const PixelKernels *kernels = select_kernels();
+    return kernels;
+}
+
+const PixelKernels *
+pixel_kernels_c(void)
+{
+    return &kernels_c;
+}
+
+const PixelKernels *
+pixel_kernels_sse2(void)
+{
+#if defined(__SSE2__)
+    if (av_get_cpu_flags() & AV_CPU_FLAG_SSE2)
+        return &kernels_sse2;
+#endif
+    return NULL;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
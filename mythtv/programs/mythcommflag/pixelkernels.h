@@ -0,0 +1,47 @@
+/*
+ * pixelkernels.h
+ *
+ * Inner pixel loops of the frame analyzers. Every kernel set computes
+ * exactly the same results; pixel_kernels() returns the fastest set that
+ * this CPU can run.
+ */
+
+#ifndef __PIXELKERNELS_H__
+#define __PIXELKERNELS_H__
+
+struct PixelKernels
+{
+    const char  *name;
+
+    /*
+     * Copy "count" pixels, taken every "step" pixels from "src", to "dst".
+     * Add their values to "*sum" and their squares to "*sumsquares", and
+     * count them in "hist".
+     */
+    void (*sample)(const unsigned char *src, int step, int count,
+            unsigned char *dst, unsigned long long *sum,
+            unsigned long long *sumsquares, int *hist);
+
+    /*
+     * Squared gradient magnitudes of "count" pixels of row "rr0", using a
+     * 45-degree rotated set of axes; "rr1" is the next row. Reads one
+     * pixel past "count" in both rows.
+     */
+    void (*sgm_row)(unsigned int *sgm, const unsigned char *rr0,
+            const unsigned char *rr1, int count);
+
+    /* Number of non-zero pixels. */
+    int (*count_set)(const unsigned char *pp, int count);
+
+    /* Number of pixels that are non-zero in both "aa" and "bb". */
+    int (*count_matched)(const unsigned char *aa, const unsigned char *bb,
+            int count);
+};
+
+const PixelKernels *pixel_kernels(void);
+const PixelKernels *pixel_kernels_c(void);
+const PixelKernels *pixel_kernels_sse2(void);   /* NULL if unavailable */
+
+#endif  /* !__PIXELKERNELS_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -188,6 +188,29 @@ static GlobalCheckBox *CommFlagFast()
     return gc;
 }
 
+static GlobalCheckBox *CommFlagMultiThreaded()
+{
+    GlobalCheckBox *gc = new GlobalCheckBox("CommFlagMultiThreaded");
+    gc->setLabel(QObject::tr("Use multiple threads for commercial detection"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, commercial detection will decode "
+                    "and analyze video using more than one CPU core. This "
+                    "finishes sooner but puts more load on the system."));
+    return gc;
+}
+
+static GlobalSpinBox *CommFlagSegments()
+{
+    GlobalSpinBox *gs = new GlobalSpinBox("CommFlagSegments", 1, 16, 1);
+    gs->setLabel(QObject::tr("Commercial detection segments"));
+    gs->setHelpText(QObject::tr("Finished recordings are split into this "
+                    "many parts, which are flagged at the same time. Set "
+                    "this to the number of CPU cores to spare for "
+                    "commercial detection."));
+    gs->setValue(1);
+    return gs;
+}
+
 static HostComboBox *AutoCommercialSkip()
 {
     HostComboBox *gc = new HostComboBox("AutoCommercialSkip");
@@ -3505,6 +3528,8 @@ GeneralSettings::GeneralSettings()
     jobs->setLabel(QObject::tr("General (Jobs)"));
     jobs->addChild(CommercialSkipMethod());
     jobs->addChild(CommFlagFast());
+    jobs->addChild(CommFlagMultiThreaded());
+    jobs->addChild(CommFlagSegments());
     jobs->addChild(AggressiveCommDetect());
     jobs->addChild(DeferAutoTranscodeDays());
 
@@ -188,6 +188,20 @@ static GlobalCheckBox *DeletesFollowLinks()
     return gc;
 };
 
+static HostLineEdit *DirectIOStorageGroups()
+{
+    HostLineEdit *he = new HostLineEdit("DirectIOStorageGroups");
+    he->setLabel(QObject::tr("Direct I/O storage groups"));
+    he->setValue("");
+    he->setHelpText(QObject::tr("Comma separated list of storage groups "
+                    "whose recordings are written on this backend with "
+                    "direct I/O in large preallocated blocks. This keeps "
+                    "recordings from pushing the files being played back "
+                    "out of the operating system's file cache. Leave empty "
+                    "to use normal buffered writes."));
+    return he;
+};
+
 static GlobalSpinBox *HDRingbufferSize()
 {
     GlobalSpinBox *bs = new GlobalSpinBox(
@@ -356,6 +370,19 @@ static GlobalSpinBox *EITTransportTimeout()
     return gc;
 }
 
+static GlobalCheckBox *FastChannelChange()
+{
+    GlobalCheckBox *gc = new GlobalCheckBox("FastChannelChange");
+    gc->setLabel(QObject::tr("Fast Live TV channel changes"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, digital TV channel changes in "
+                                "Live TV start on the program tables seen the "
+                                "last time the channel was tuned instead of "
+                                "waiting for them to be broadcast again. The "
+                                "tables are checked once they are received."));
+    return gc;
+}
+
 static GlobalCheckBox *MasterBackendOverride()
 {
     GlobalCheckBox *gc = new GlobalCheckBox("MasterBackendOverride");
@@ -919,6 +946,7 @@ BackendSettings::BackendSettings() {
     fmh1->addChild(TruncateDeletes());
     fm->addChild(fmh1);
     fm->addChild(HDRingbufferSize());
+    fm->addChild(DirectIOStorageGroups());
     fm->addChild(StorageScheduler());
     group2->addChild(fm);
     VerticalConfigurationGroup* upnp = new VerticalConfigurationGroup();
@@ -929,6 +957,7 @@ BackendSettings::BackendSettings() {
     group2->addChild(MiscStatusScript());
     group2->addChild(DisableAutomaticBackup());
     group2->addChild(DisableFirewireReset());
+    group2->addChild(FastChannelChange());
     addChild(group2);
 
     VerticalConfigurationGroup* group2a1 = new VerticalConfigurationGroup(false);
@@ -1,10 +1,26 @@
+// POSIX headers
+#include <sys/types.h>
+#include <sys/time.h>
+#include <unistd.h>
+#ifndef USING_MINGW
+#include <sys/socket.h>
+#endif
+
 // C++ includes
+#include <algorithm>
 #include <iostream>
+using namespace std;
+
+// Qt headers
+#include <QWaitCondition>
+#include <QVector>
+#include <QMutex>
 
 // libmyth* headers
 #include "exitcodes.h"
 #include "mythcorecontext.h"
 #include "mythlogging.h"
+#include "mythsocket.h"
 #include "remoteutil.h"
 #include "scheduledrecording.h"
 #include "videometadata.h"
@@ -95,6 +111,138 @@ static int ParseVideoFilename(const MythUtilCommandLineParser &cmdline)
     return GENERIC_EXIT_OK;
 }
 
+#ifndef USING_MINGW
+static int64_t socket_bench_now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/// Records how long each timestamp written to a benchmark socket took
+/// to reach the readyRead() callback, in microseconds.
+class SocketBenchCB : public MythSocketCBs
+{
+  public:
+    SocketBenchCB() : m_received(0) {}
+
+    virtual void connected(MythSocket*) {}
+    virtual void connectionFailed(MythSocket*) {}
+    virtual void connectionClosed(MythSocket*) {}
+    virtual void readyRead(MythSocket *sock)
+    {
+        int64_t sent;
+        while (sock->bytesAvailable() >= (qint64)sizeof(sent) &&
+               sock->readBlock((char*)&sent, sizeof(sent)) == sizeof(sent))
+        {
+            int64_t latency = socket_bench_now() - sent;
+            QMutexLocker locker(&m_lock);
+            m_latencies.push_back(latency);
+            m_received++;
+            m_wait.wakeAll();
+        }
+    }
+
+    QMutex           m_lock;
+    QWaitCondition   m_wait;
+    uint             m_received;
+    QVector<int64_t> m_latencies;
+};
+#endif
+
+static int SocketBench(const MythUtilCommandLineParser &cmdline)
+{
+#ifdef USING_MINGW
+    LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "--socketbench needs socketpair()\n");
+    return GENERIC_EXIT_NOT_OK;
+#else
+    uint count      = cmdline.toUInt("sockets");
+    uint iterations = cmdline.toUInt("iterations");
+    if (!count || !iterations)
+        return GENERIC_EXIT_INVALID_CMDLINE;
+
+    // The socket thread may still call back while the sockets are
+    // being released, so this has to outlive the function.
+    static SocketBenchCB cb;
+    cb.m_received = 0;
+    cb.m_latencies.clear();
+
+    QList<MythSocket*> sockets;
+    QList<int> writers;
+    for (uint i = 0; i < count; i++)
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+        {
+            LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+                QString("Only opened %1 socket pairs").arg(i) + ENO + "\n");
+            break;
+        }
+        sockets.push_back(new MythSocket(fds[0], &cb));
+        writers.push_back(fds[1]);
+    }
+
+    int ret = GENERIC_EXIT_OK;
+    for (uint n = 0; n < iterations && ret == GENERIC_EXIT_OK; n++)
+    {
+        for (int i = 0; i < writers.size(); i++)
+        {
+            int64_t now = socket_bench_now();
+            if (write(writers[i], &now, sizeof(now)) != sizeof(now))
+            {
+                LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+                    "Unable to write to a socket" + ENO + "\n");
+                ret = GENERIC_EXIT_NOT_OK;
+                break;
+            }
+        }
+
+        QMutexLocker locker(&cb.m_lock);
+        uint expected = (n + 1) * writers.size();
+        while (ret == GENERIC_EXIT_OK && cb.m_received < expected)
+        {
+            if (!cb.m_wait.wait(&cb.m_lock, 5000))
+            {
+                LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+                    QString("Timed out waiting for %1 callbacks\n")
+                    .arg(expected - cb.m_received));
+                ret = GENERIC_EXIT_NOT_OK;
+            }
+        }
+    }
+
+    QVector<int64_t> latencies;
+    {
+        QMutexLocker locker(&cb.m_lock);
+        latencies = cb.m_latencies;
+    }
+
+    if (!latencies.empty())
+    {
+        sort(latencies.begin(), latencies.end());
+        int64_t total = 0;
+        for (int i = 0; i < latencies.size(); i++)
+            total += latencies[i];
+
+        LOG(VB_STDIO|VB_FLUSH, logLevel,
+            QString("%1 sockets, %2 callbacks: latency average %3 us, "
+                    "median %4 us, 99th percentile %5 us, max %6 us\n")
+            .arg(writers.size()).arg(latencies.size())
+            .arg(total / latencies.size())
+            .arg(latencies[latencies.size() / 2])
+            .arg(latencies[latencies.size() * 99 / 100])
+            .arg(latencies.back()));
+    }
+
+    for (int i = 0; i < sockets.size(); i++)
+        sockets[i]->DecrRef();
+    for (int i = 0; i < writers.size(); i++)
+        close(writers[i]);
+
+    return ret;
+#endif
+}
+
 void registerBackendUtils(UtilMap &utilMap)
 {
     utilMap["clearcache"]           = &ClearSettingsCache;
@@ -103,6 +251,7 @@ void registerBackendUtils(UtilMap &utilMap)
     utilMap["scanvideos"]           = &ScanVideos;
     utilMap["systemevent"]          = &SendSystemEvent;
     utilMap["parsevideo"]           = &ParseVideoFilename;
+    utilMap["socketbench"]          = &SocketBench;
 }
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
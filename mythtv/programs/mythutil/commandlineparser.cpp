@@ -31,6 +31,29 @@ void MythUtilCommandLineParser::LoadArguments(void)
                 ->SetGroup("MPEG-TS")
                 ->SetRequiredChild("infile")
                 ->SetChild("outfile")
+        << add("--isdbtextbench", "isdbtextbench", false,
+                "Benchmark the ISDB EIT text decoder on a capture file, "
+                "optionally writing the decoded text for comparison", "")
+                ->SetGroup("MPEG-TS")
+                ->SetRequiredChild("infile")
+                ->SetChild("outfile")
+        << add("--pidbench", "pidbench", false,
+                "Benchmark TS packet dispatch on a capture file",
+                "Replays the start of a capture file through the MPEG-TS "
+                "packet dispatch and reports the throughput. By default "
+                "all pids are routed to a writing listener, use --pids "
+                "to select them and --ptspids to route some to the "
+                "audio/video listener instead.")
+                ->SetGroup("MPEG-TS")
+                ->SetRequiredChild("infile")
+        << add("--keyframebench", "keyframebench", false,
+                "Benchmark the MPEG-2 and H.264 keyframe search on a "
+                "capture file",
+                "Collects the video packets at the start of a capture file "
+                "and replays them through the keyframe finders used while "
+                "recording, reporting the throughput for each video stream.")
+                ->SetGroup("MPEG-TS")
+                ->SetRequiredChild("infile")
 
         // markuputils.cpp
         << add("--gencutlist", "gencutlist", false,
@@ -101,6 +124,14 @@ void MythUtilCommandLineParser::LoadArguments(void)
                 "Diagnostic tool for testing filename formats against what "
                 "the Video Library name parser will detect them as.")
                 ->SetGroup("Backend")
+        << add("--socketbench", "socketbench", false,
+                "Measure the socket readyRead() callback latency.",
+                "Opens many local socket pairs, repeatedly writes a "
+                "timestamp to each of them and reports how long it took "
+                "for the readyRead() callbacks to see them. Set "
+                "MYTHTV_SOCKET_THREADS to spread the sockets over more "
+                "threads.")
+                ->SetGroup("Backend")
 
         // jobutils.cpp
         << add("--queuejob", "queuejob", "",
@@ -124,7 +155,8 @@ void MythUtilCommandLineParser::LoadArguments(void)
     // mpegutils.cpp
     add("--pids", "pids", "", "Pids to process", "")
         ->SetRequiredChildOf("pidfilter")
-        ->SetRequiredChildOf("pidprinter");
+        ->SetRequiredChildOf("pidprinter")
+        ->SetChildOf("pidbench");
     add("--ptspids", "ptspids", "", "Pids to extract PTS from", "")
         ->SetGroup("MPEG-TS");
     add("--packetsize", "packetsize", 188, "TS Packet Size", "")
@@ -134,6 +166,17 @@ void MythUtilCommandLineParser::LoadArguments(void)
         ->SetChildOf("pidprinter");
     add("--xml", "xml", false, "Enables XML output of PSIP", "")
         ->SetChildOf("pidprinter");
+    add("--iterations", "iterations", 100,
+            "Number of times to decode each string, or to replay "
+            "the capture", "")
+        ->SetChildOf("isdbtextbench")
+        ->SetChildOf("pidbench")
+        ->SetChildOf("keyframebench")
+        ->SetChildOf("socketbench");
+
+    // backendutils.cpp
+    add("--sockets", "sockets", 256, "Number of socket pairs to open", "")
+        ->SetChildOf("socketbench");
 
     // messageutils.cpp
     add("--udpport", "udpport", 6948, "(optional) UDP Port to send to", "")
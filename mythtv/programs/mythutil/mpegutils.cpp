@@ -30,6 +30,9 @@
 #include "ringbuffer.h"
 #include "dvbtables.h"
 #include "exitcodes.h"
+#include "mythtimer.h"
+#include "H264Parser.h"
+#include "startcode.h"
 
 // Application local headers
 #include "mpegutils.h"
@@ -842,9 +845,551 @@ static int pid_printer(const MythUtilCommandLineParser &cmdline)
     return GENERIC_EXIT_OK;
 }
 
+class ISDBTextCollector : public DVBEITStreamListener
+{
+  public:
+    virtual void HandleEIT(const DVBEventInformationTable *eit)
+    {
+        for (uint i = 0; i < eit->EventCount(); i++)
+        {
+            desc_list_t list = MPEGDescriptor::Parse(
+                eit->Descriptors(i), eit->DescriptorsLength(i));
+            desc_list_t sed =
+                MPEGDescriptor::FindAll(list, DescriptorID::short_event);
+            for (uint j = 0; j < sed.size(); j++)
+            {
+                const unsigned char *d = sed[j];
+                uint name_len = d[5];
+                if (name_len + 7 > (uint)d[1] + 2)
+                    continue;
+                Add(d + 6, name_len);
+                Add(d + 7 + name_len, d[6 + name_len]);
+            }
+        }
+    }
+
+    virtual void HandleEIT(const PremiereContentInformationTable*) {}
+
+    void Add(const unsigned char *src, uint len)
+    {
+        if (!len)
+            return;
+        QByteArray ba((const char*)src, len);
+        if (m_seen.contains(ba))
+            return;
+        m_seen.insert(ba, true);
+        m_strings.push_back(ba);
+    }
+
+  public:
+    QHash<QByteArray,bool> m_seen;
+    QList<QByteArray>      m_strings;
+};
+
+static int isdb_text_bench(const MythUtilCommandLineParser &cmdline)
+{
+    if (cmdline.toString("infile").isEmpty())
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "Missing --infile option\n");
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+    QString src = cmdline.toString("infile");
+
+    RingBuffer *srcRB = RingBuffer::Create(src, false);
+    if (!srcRB)
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "Couldn't open input URL\n");
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    QString dest = cmdline.toString("outfile");
+    RingBuffer *out = NULL;
+    if (!dest.isEmpty())
+    {
+        out = RingBuffer::Create(dest, true);
+        if (!out)
+        {
+            LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "Couldn't open output URL\n");
+            delete srcRB;
+            return GENERIC_EXIT_NOT_OK;
+        }
+    }
+
+    uint iterations = cmdline.toUInt("iterations");
+    if (!iterations)
+        iterations = 1;
+
+    // Collect the raw event names and texts from all ISDB EIT sections
+    ScanStreamData *sd = new ScanStreamData(true, kKindISDB);
+    sd->AddListeningPID(DVB_EIT_PID);
+    ISDBTextCollector *collector = new ISDBTextCollector();
+    sd->AddDVBEITListener(collector);
+
+    const int kBufSize = 2 * 1024 * 1024;
+    char *buffer = new char[kBufSize];
+    int offset = 0;
+
+    while (true)
+    {
+        int r = srcRB->Read(&buffer[offset], kBufSize - offset);
+        if (r <= 0)
+            break;
+        int len = offset + r;
+        offset = sd->ProcessData((const unsigned char*)buffer, len);
+    }
+    delete[] buffer;
+
+    const QList<QByteArray> &strings = collector->m_strings;
+    uint64_t total_bytes = 0ULL;
+    for (int i = 0; i < strings.size(); i++)
+        total_bytes += strings[i].size();
+
+    LOG(VB_STDIO|VB_FLUSH, logLevel,
+        QString("Collected %1 unique strings, %2 bytes\n")
+        .arg(strings.size()).arg(total_bytes));
+
+    // Decode everything once, for the golden output
+    IsdbDecode handle = ISDBTextDecoder::Get();
+    unsigned char obuf[4096 * 6];
+    for (int i = 0; out && (i < strings.size()); i++)
+    {
+        uint olen = isdb_decode_text(
+            handle, (const unsigned char*)strings[i].constData(),
+            strings[i].size(), obuf, sizeof(obuf));
+        out->Write(obuf, olen);
+        out->Write("\n", 1);
+    }
+
+    MythTimer t;
+    t.start();
+    for (uint n = 0; n < iterations; n++)
+    {
+        for (int i = 0; i < strings.size(); i++)
+        {
+            isdb_decode_text(
+                handle, (const unsigned char*)strings[i].constData(),
+                strings[i].size(), obuf, sizeof(obuf));
+        }
+    }
+    int msecs = max(t.elapsed(), 1);
+
+    double mbytes = (double)total_bytes * iterations / (1024.0 * 1024.0);
+    LOG(VB_STDIO|VB_FLUSH, logLevel,
+        QString("Decoded %1 strings in %2 ms: %3 strings/s, %4 MB/s\n")
+        .arg((uint64_t)strings.size() * iterations).arg(msecs)
+        .arg((uint64_t)strings.size() * iterations * 1000 / msecs)
+        .arg(mbytes * 1000.0 / msecs, 0, 'f', 2));
+
+    delete sd;
+    delete collector;
+    delete srcRB;
+    delete out;
+
+    return GENERIC_EXIT_OK;
+}
+
+class PacketCounter : public TSPacketListener, public TSPacketListenerAV
+{
+  public:
+    PacketCounter() : m_writing(0), m_video(0), m_audio(0) { }
+
+    virtual bool ProcessTSPacket(const TSPacket&)
+        { m_writing++; return true; }
+    virtual bool ProcessVideoTSPacket(const TSPacket&)
+        { m_video++; return true; }
+    virtual bool ProcessAudioTSPacket(const TSPacket&)
+        { m_audio++; return true; }
+
+  public:
+    uint64_t m_writing;
+    uint64_t m_video;
+    uint64_t m_audio;
+};
+
+static int pid_bench(const MythUtilCommandLineParser &cmdline)
+{
+    if (cmdline.toString("infile").isEmpty())
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "Missing --infile option\n");
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+    QString src = cmdline.toString("infile");
+
+    RingBuffer *srcRB = RingBuffer::Create(src, false);
+    if (!srcRB)
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "Couldn't open input URL\n");
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    uint iterations = cmdline.toUInt("iterations");
+    if (!iterations)
+        iterations = 1;
+
+    // Load the start of the capture into memory so that only the
+    // packet dispatch is timed, not the file reads.
+    const int kBufSize = 2 * 1024 * 1024;
+    const int kMaxSize = 256 * 1024 * 1024;
+    QByteArray data;
+    char *buffer = new char[kBufSize];
+    while (data.size() < kMaxSize)
+    {
+        int r = srcRB->Read(buffer, kBufSize);
+        if (r <= 0)
+            break;
+        data.append(buffer, r);
+    }
+    delete[] buffer;
+    delete srcRB;
+
+    if (data.size() < (int) TSPacket::kSize)
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "Input file is too short\n");
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    // Route the requested PIDs, or every PID in the capture, to the
+    // writing listener, and any --ptspids to the audio/video listener.
+    const int packet_size = TSPacket::kSize;
+    QHash<uint,bool> use_pid = extract_pids(cmdline.toString("pids"), false);
+    if (use_pid.empty())
+    {
+        const unsigned char *d = (const unsigned char*) data.constData();
+        for (int pos = 0; pos + packet_size <= data.size();
+             pos += packet_size)
+        {
+            if (d[pos] == SYNC_BYTE)
+                use_pid[((d[pos+1] << 8) | d[pos+2]) & 0x1fff] = true;
+        }
+    }
+    QHash<uint,bool> av_pid = extract_pids(cmdline.toString("ptspids"), false);
+
+    MPEGStreamData *sd = new MPEGStreamData(-1, false);
+    PacketCounter *counter = new PacketCounter();
+    sd->AddWritingListener(counter);
+    sd->AddAVListener(counter);
+
+    QHash<uint,bool>::const_iterator it = use_pid.begin();
+    for (; it != use_pid.end(); ++it)
+        sd->AddWritingPID(it.key());
+    for (it = av_pid.begin(); it != av_pid.end(); ++it)
+        sd->AddAudioPID(it.key());
+
+    MythTimer t;
+    t.start();
+    uint64_t total_bytes = 0ULL;
+    for (uint n = 0; n < iterations; n++)
+    {
+        const unsigned char *d = (const unsigned char*) data.constData();
+        int len = data.size();
+        while (len >= packet_size)
+        {
+            int chunk = min(len, kBufSize);
+            int left = sd->ProcessData(d, chunk);
+            int used = chunk - left;
+            if (used <= 0)
+                break;
+            d += used;
+            len -= used;
+            total_bytes += used;
+        }
+    }
+    int msecs = max(t.elapsed(), 1);
+
+    uint64_t packets = total_bytes / packet_size;
+    LOG(VB_STDIO|VB_FLUSH, logLevel,
+        QString("Dispatched %1 packets in %2 ms: %3 packets/s, %4 MB/s\n")
+        .arg(packets).arg(msecs).arg(packets * 1000 / msecs)
+        .arg((double)total_bytes * 1000.0 / (1024.0 * 1024.0 * msecs),
+             0, 'f', 2));
+    LOG(VB_STDIO|VB_FLUSH, logLevel,
+        QString("Delivered %1 writing, %2 video, %3 audio packets\n")
+        .arg(counter->m_writing).arg(counter->m_video)
+        .arg(counter->m_audio));
+
+    delete sd;
+    delete counter;
+
+    return GENERIC_EXIT_OK;
+}
+
+class VideoPIDFinder : public MPEGStreamListener
+{
+  public:
+    VideoPIDFinder(MPEGStreamData *sd) : m_sd(sd)
+    {
+        m_sd->AddListeningPID(MPEG_PAT_PID);
+    }
+
+    void HandlePAT(const ProgramAssociationTable *pat)
+    {
+        if (!pat)
+            return;
+        for (uint i = 0; i < pat->ProgramCount(); i++)
+            m_sd->AddListeningPID(pat->ProgramPID(i));
+    }
+
+    void HandleCAT(const ConditionalAccessTable*) { }
+
+    void HandlePMT(uint, const ProgramMapTable *pmt)
+    {
+        if (!pmt)
+            return;
+        for (uint i = 0; i < pmt->StreamCount(); i++)
+        {
+            uint type = pmt->StreamType(i);
+            if (StreamID::MPEG1Video == type ||
+                StreamID::MPEG2Video == type ||
+                StreamID::H264Video  == type)
+            {
+                m_video_pids[pmt->StreamPID(i)] = type;
+            }
+        }
+    }
+
+    void HandleEncryptionStatus(uint, bool) { }
+
+  public:
+    MPEGStreamData   *m_sd;
+    QMap<uint,uint>   m_video_pids; ///< pid -> stream type
+};
+
+typedef const uint8_t *(*start_code_func)(
+    const uint8_t*, const uint8_t*, uint32_t*);
+
+/// Scans the MPEG-2 video packets the way DTVRecorder::FindMPEG2Keyframes()
+/// does, returns the number of pictures seen.
+static uint64_t scan_mpeg2(const QByteArray &packets,
+                           start_code_func find, uint64_t &gops)
+{
+    uint64_t frames = 0;
+    uint32_t start_code = 0xffffffff;
+    const TSPacket *pkt = reinterpret_cast<const TSPacket*>(
+        packets.constData());
+    const TSPacket *end = pkt + packets.size() / TSPacket::kSize;
+    for (; pkt < end; ++pkt)
+    {
+        const uint8_t *bufptr = pkt->data() + pkt->AFCOffset();
+        const uint8_t *bufend = pkt->data() + TSPacket::kSize;
+        while (bufptr < bufend)
+        {
+            bufptr = find(bufptr, bufend, &start_code);
+            if ((start_code & 0xffffff00) != 0x00000100)
+                continue;
+            const int stream_id = start_code & 0x000000ff;
+            if (PESStreamID::PictureStartCode == stream_id)
+                frames++;
+            else if (PESStreamID::GOPStartCode == stream_id)
+                gops++;
+        }
+    }
+    return frames;
+}
+
+/// Feeds the H.264 video packets through H264Parser the way
+/// DTVRecorder::FindH264Keyframes() does, returns the number of
+/// frames seen.
+static uint64_t scan_h264(const QByteArray &packets,
+                          H264Parser &parser, uint64_t &keyframes)
+{
+    uint64_t frames = 0;
+    bool pes_synced = false;
+    const TSPacket *it = reinterpret_cast<const TSPacket*>(
+        packets.constData());
+    const TSPacket *end = it + packets.size() / TSPacket::kSize;
+    for (; it < end; ++it)
+    {
+        const TSPacket &pkt = *it;
+        uint i = pkt.AFCOffset();
+        if (pkt.PayloadStart())
+        {
+            // skip the PES header
+            pes_synced = false;
+            if (i + 9 >= TSPacket::kSize ||
+                pkt.data()[i] != 0x00 || pkt.data()[i+1] != 0x00 ||
+                pkt.data()[i+2] != 0x01)
+            {
+                continue;
+            }
+            i += 9 + pkt.data()[i + 8];
+            pes_synced = true;
+        }
+        if (!pes_synced)
+            continue;
+
+        for (; i < TSPacket::kSize; ++i)
+        {
+            uint32_t bytes_used = parser.addBytes(
+                pkt.data() + i, TSPacket::kSize - i, 0);
+            i += (bytes_used - 1);
+
+            if (parser.stateChanged() && parser.onFrameStart() &&
+                parser.FieldType() != H264Parser::FIELD_BOTTOM)
+            {
+                frames++;
+                if (parser.onKeyFrameStart())
+                    keyframes++;
+            }
+        }
+    }
+    return frames;
+}
+
+static QString bench_rate(uint64_t bytes, int msecs)
+{
+    return QString::number(
+        (double)bytes * 1000.0 / (1024.0 * 1024.0 * max(msecs, 1)), 'f', 2);
+}
+
+static int keyframe_bench(const MythUtilCommandLineParser &cmdline)
+{
+    if (cmdline.toString("infile").isEmpty())
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "Missing --infile option\n");
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+    QString src = cmdline.toString("infile");
+
+    RingBuffer *srcRB = RingBuffer::Create(src, false);
+    if (!srcRB)
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR, "Couldn't open input URL\n");
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    uint iterations = cmdline.toUInt("iterations");
+    if (!iterations)
+        iterations = 1;
+
+    // Find the video streams and collect their packets, so that only
+    // the keyframe search is timed.
+    MPEGStreamData *sd = new MPEGStreamData(-1, false);
+    VideoPIDFinder *finder = new VideoPIDFinder(sd);
+    sd->AddMPEGListener(finder);
+
+    const int kBufSize = 2 * 1024 * 1024;
+    const int kMaxSize = 256 * 1024 * 1024;
+    const int packet_size = TSPacket::kSize;
+    QMap<uint, QByteArray> video;
+    char *buffer = new char[kBufSize];
+    int offset = 0;
+    int total = 0;
+    while (total < kMaxSize)
+    {
+        int r = srcRB->Read(&buffer[offset], kBufSize - offset);
+        if (r <= 0)
+            break;
+        int len = offset + r;
+        total += r;
+        const unsigned char *d = (const unsigned char*) buffer;
+        int pos = 0;
+        for (; pos + packet_size <= len; pos += packet_size)
+        {
+            if (d[pos] != SYNC_BYTE)
+            {
+                int sync = resync_stream(buffer, pos + 1, len, packet_size);
+                if (sync < 0)
+                {
+                    // keep the tail and try again after the next read
+                    pos = len - packet_size + 1;
+                    break;
+                }
+                pos = sync;
+            }
+            const TSPacket *pkt = reinterpret_cast<const TSPacket*>(d + pos);
+            if (finder->m_video_pids.contains(pkt->PID()))
+            {
+                if (pkt->HasPayload() && !pkt->TransportError())
+                    video[pkt->PID()].append((const char*) pkt, packet_size);
+            }
+            else
+            {
+                sd->ProcessData(d + pos, packet_size);
+            }
+        }
+        offset = len - pos;
+        if (offset > 0)
+            memmove(buffer, buffer + pos, offset);
+    }
+    delete[] buffer;
+    delete srcRB;
+
+    if (video.empty())
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+            "No MPEG-2 or H.264 video found in the input file\n");
+        delete sd;
+        delete finder;
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    QMap<uint, QByteArray>::const_iterator it = video.begin();
+    for (; it != video.end(); ++it)
+    {
+        uint type = finder->m_video_pids[it.key()];
+        uint64_t bytes = (uint64_t)(*it).size() * iterations;
+        QString desc = QString("pid 0x%1 (%2)")
+            .arg(it.key(), 0, 16).arg(StreamID::toString(type));
+
+        if (StreamID::H264Video == type)
+        {
+            H264Parser parser;
+            uint64_t frames = 0, keyframes = 0;
+            MythTimer t;
+            t.start();
+            for (uint n = 0; n < iterations; n++)
+            {
+                parser.Reset();
+                frames += scan_h264(*it, parser, keyframes);
+            }
+            int msecs = t.elapsed();
+
+            LOG(VB_STDIO|VB_FLUSH, logLevel,
+                QString("%1: %2 frames, %3 keyframes, %4 MB/s\n")
+                .arg(desc).arg(frames / iterations)
+                .arg(keyframes / iterations).arg(bench_rate(bytes, msecs)));
+            continue;
+        }
+
+        uint64_t frames = 0, gops = 0, frames_c = 0, gops_c = 0;
+        MythTimer t;
+        t.start();
+        for (uint n = 0; n < iterations; n++)
+            frames += scan_mpeg2(*it, &find_start_code, gops);
+        int msecs = t.elapsed();
+
+        t.start();
+        for (uint n = 0; n < iterations; n++)
+            frames_c += scan_mpeg2(*it, &find_start_code_c, gops_c);
+        int msecs_c = t.elapsed();
+
+        LOG(VB_STDIO|VB_FLUSH, logLevel,
+            QString("%1: %2 frames, %3 GOPs, %4 MB/s (plain C %5 MB/s)\n")
+            .arg(desc).arg(frames / iterations).arg(gops / iterations)
+            .arg(bench_rate(bytes, msecs)).arg(bench_rate(bytes, msecs_c)));
+
+        if (frames != frames_c || gops != gops_c)
+        {
+            LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+                "Start code scanners disagree on the frame count\n");
+            delete sd;
+            delete finder;
+            return GENERIC_EXIT_NOT_OK;
+        }
+    }
+
+    delete sd;
+    delete finder;
+
+    return GENERIC_EXIT_OK;
+}
+
 void registerMPEGUtils(UtilMap &utilMap)
 {
     utilMap["pidcounter"] = &pid_counter;
     utilMap["pidfilter"]  = &pid_filter;
     utilMap["pidprinter"] = &pid_printer;
+    utilMap["isdbtextbench"] = &isdb_text_bench;
+    utilMap["pidbench"]   = &pid_bench;
+    utilMap["keyframebench"] = &keyframe_bench;
 }